@@ -36,8 +36,16 @@
 #include <utility>
 #include <future>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <QThread>
 #include <QEventLoop>
+#include <QCoreApplication>
 #include <QMutex>
 #include <QProcess>
 #include <QVariant>
@@ -98,6 +106,16 @@
  * 8. .manages_multiple_futures(). This method can be used to check if a future powers
  *    its own task or manages other futures.
  *
+ * Tasks do not get a thread of their own,they run on a pool of threads sized to the number
+ * of cores. Tasks that spend most of their time blocked(waiting on processes for example)
+ * should be started with Task::run_io() to put them on a separate lane that grows and
+ * shrinks with demand. .all_threads(),.first_thread() and .thread_at() return null
+ * pointers as a result.
+ *
+ * .get() does not hand the task to a lane,it runs it inline on the calling thread.A task
+ * that blocks and is waited on with .get() from inside another task only stays off the
+ * pool if that other task was started with Task::run_io() too.
+ *
  *
  * The future is of type "Task::future<T>&" and "std::reference_wrapper"[1]
  * class can be used if they are to be managed in a container that can not handle references.
@@ -149,6 +167,336 @@ namespace Task
 		return pair< void >( std::move( e ),std::move( f ) ) ;
 	}	
 
+	struct statistics{
+
+		std::size_t workers ;
+		std::size_t queueDepth ;
+		std::size_t peakQueueDepth ;
+		unsigned long long tasks ;
+		double averageLatency ;
+		double maximumLatency ;
+		std::size_t ioThreads ;
+		std::size_t peakIoThreads ;
+		std::size_t ioQueueDepth ;
+		unsigned long long ioTasks ;
+		double ioAverageLatency ;
+		double ioMaximumLatency ;
+	} ;
+
+	namespace detail
+	{
+		/*
+		 * Latency is the time a task spends waiting in a queue before it starts running.
+		 */
+		class latency
+		{
+		public:
+			using clock = std::chrono::steady_clock ;
+
+			void add( clock::time_point queued )
+			{
+				auto e = std::chrono::duration_cast< std::chrono::microseconds >( clock::now() - queued ) ;
+
+				auto m = static_cast< unsigned long long >( e.count() ) ;
+
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+				m_tasks++ ;
+				m_total += m ;
+
+				if( m > m_maximum ){
+
+					m_maximum = m ;
+				}
+			}
+			void get( unsigned long long& tasks,double& average,double& maximum )
+			{
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+				tasks   = m_tasks ;
+				average = m_tasks ? double( m_total ) / double( m_tasks ) / 1000 : 0 ;
+				maximum = double( m_maximum ) / 1000 ;
+			}
+		private:
+			std::mutex m_mutex ;
+			unsigned long long m_tasks = 0 ;
+			unsigned long long m_total = 0 ;
+			unsigned long long m_maximum = 0 ;
+		} ;
+
+		struct job{
+
+			std::function< void() > function ;
+			latency::clock::time_point queued ;
+		} ;
+
+		/*
+		 * A fixed size work stealing pool.
+		 *
+		 * Every worker has its own queue,tasks started from a worker go to the back of
+		 * its own queue and everything else is spread across all queues.A worker takes
+		 * from the back of its own queue and when it runs out,it steals from the front
+		 * of the others.
+		 *
+		 * The pool is never destroyed and its threads are never joined,some tasks run
+		 * for as long as the application does.
+		 */
+		class pool
+		{
+		public:
+			static pool& instance()
+			{
+				static pool * p = new pool() ;
+				return *p ;
+			}
+			void submit( std::function< void() > function )
+			{
+				auto& me = pool::current() ;
+
+				std::size_t index ;
+
+				if( me.first == this ){
+
+					index = me.second ;
+				}else{
+					index = m_next++ % m_queues.size() ;
+				}
+
+				{
+					std::lock_guard< std::mutex > lock( m_queues[ index ]->mutex ) ;
+
+					m_queues[ index ]->jobs.push_back( { std::move( function ),latency::clock::now() } ) ;
+				}
+
+				auto depth = ++m_queued ;
+
+				auto peak = m_peak.load() ;
+
+				while( depth > peak && !m_peak.compare_exchange_weak( peak,depth ) ){}
+
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+				m_cv.notify_one() ;
+			}
+			void stats( Task::statistics& s )
+			{
+				s.workers        = m_queues.size() ;
+				s.queueDepth     = m_queued.load() ;
+				s.peakQueueDepth = m_peak.load() ;
+
+				m_latency.get( s.tasks,s.averageLatency,s.maximumLatency ) ;
+			}
+		private:
+			struct queue{
+
+				std::mutex mutex ;
+				std::deque< job > jobs ;
+			} ;
+			static std::pair< pool *,std::size_t >& current()
+			{
+				static thread_local std::pair< pool *,std::size_t > m( nullptr,0 ) ;
+				return m ;
+			}
+			pool()
+			{
+				auto s = std::thread::hardware_concurrency() ;
+
+				if( s < 2 ){
+
+					s = 2 ;
+				}
+
+				for( decltype( s ) i = 0 ; i < s ; i++ ){
+
+					m_queues.emplace_back( std::make_unique< queue >() ) ;
+				}
+
+				for( decltype( s ) i = 0 ; i < s ; i++ ){
+
+					std::thread( [ this,i ](){ this->work( i ) ; } ).detach() ;
+				}
+			}
+			bool take( std::size_t index,job& e )
+			{
+				{
+					auto& m = *m_queues[ index ] ;
+
+					std::lock_guard< std::mutex > lock( m.mutex ) ;
+
+					if( !m.jobs.empty() ){
+
+						e = std::move( m.jobs.back() ) ;
+						m.jobs.pop_back() ;
+
+						return true ;
+					}
+				}
+
+				for( std::size_t i = 1 ; i < m_queues.size() ; i++ ){
+
+					auto& m = *m_queues[ ( index + i ) % m_queues.size() ] ;
+
+					std::lock_guard< std::mutex > lock( m.mutex ) ;
+
+					if( !m.jobs.empty() ){
+
+						e = std::move( m.jobs.front() ) ;
+						m.jobs.pop_front() ;
+
+						return true ;
+					}
+				}
+
+				return false ;
+			}
+			void work( std::size_t index )
+			{
+				pool::current() = { this,index } ;
+
+				job e ;
+
+				while( true ){
+
+					if( this->take( index,e ) ){
+
+						m_queued-- ;
+
+						m_latency.add( e.queued ) ;
+
+						e.function() ;
+
+						e.function = nullptr ;
+					}else{
+						std::unique_lock< std::mutex > lock( m_mutex ) ;
+
+						m_cv.wait( lock,[ this ](){ return m_queued.load() > 0 ; } ) ;
+					}
+				}
+			}
+			std::vector< std::unique_ptr< queue > > m_queues ;
+			std::atomic< std::size_t > m_next{ 0 } ;
+			std::atomic< std::size_t > m_queued{ 0 } ;
+			std::atomic< std::size_t > m_peak{ 0 } ;
+			std::mutex m_mutex ;
+			std::condition_variable m_cv ;
+			latency m_latency ;
+		} ;
+
+		/*
+		 * A lane for tasks that mostly wait.It starts a thread when a task is queued and
+		 * no thread is idle and a thread that has been idle for 30 seconds goes away.
+		 */
+		class ioLane
+		{
+		public:
+			static ioLane& instance()
+			{
+				static ioLane * p = new ioLane() ;
+				return *p ;
+			}
+			void submit( std::function< void() > function )
+			{
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+				m_jobs.push_back( { std::move( function ),latency::clock::now() } ) ;
+
+				if( m_idle > 0 ){
+
+					m_cv.notify_one() ;
+				}else{
+					m_threads++ ;
+
+					if( m_threads > m_peak ){
+
+						m_peak = m_threads ;
+					}
+
+					std::thread( [ this ](){ this->work() ; } ).detach() ;
+				}
+			}
+			void stats( Task::statistics& s )
+			{
+				{
+					std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+					s.ioThreads     = m_threads ;
+					s.peakIoThreads = m_peak ;
+					s.ioQueueDepth  = m_jobs.size() ;
+				}
+
+				m_latency.get( s.ioTasks,s.ioAverageLatency,s.ioMaximumLatency ) ;
+			}
+		private:
+			void work()
+			{
+				std::unique_lock< std::mutex > lock( m_mutex ) ;
+
+				while( true ){
+
+					if( m_jobs.empty() ){
+
+						m_idle++ ;
+
+						auto m = m_cv.wait_for( lock,std::chrono::seconds( 30 ),[ this ](){
+
+							return !m_jobs.empty() ;
+						} ) ;
+
+						m_idle-- ;
+
+						if( !m ){
+
+							m_threads-- ;
+
+							return ;
+						}
+					}
+
+					auto e = std::move( m_jobs.front() ) ;
+
+					m_jobs.pop_front() ;
+
+					lock.unlock() ;
+
+					m_latency.add( e.queued ) ;
+
+					e.function() ;
+
+					e.function = nullptr ;
+
+					lock.lock() ;
+				}
+			}
+			std::mutex m_mutex ;
+			std::condition_variable m_cv ;
+			std::deque< job > m_jobs ;
+			std::size_t m_threads = 0 ;
+			std::size_t m_peak = 0 ;
+			std::size_t m_idle = 0 ;
+			latency m_latency ;
+		} ;
+
+		static inline void submit( std::function< void() > function,bool io )
+		{
+			if( io ){
+
+				Task::detail::ioLane::instance().submit( std::move( function ) ) ;
+			}else{
+				Task::detail::pool::instance().submit( std::move( function ) ) ;
+			}
+		}
+	}
+
+	static inline Task::statistics pool_statistics()
+	{
+		Task::statistics s ;
+
+		Task::detail::pool::instance().stats( s ) ;
+		Task::detail::ioLane::instance().stats( s ) ;
+
+		return s ;
+	}
+
 	template< typename T >
 	class future : private QObject
 	{
@@ -240,11 +588,16 @@ namespace Task
 		}
 		QThread * first_thread()
 		{
-			return m_threads[ 0 ] ;
+			return m_threads.empty() ? nullptr : m_threads[ 0 ] ;
 		}
+		/*
+		 * Futures that manage other futures hold one entry per managed future and the
+		 * entry is null since pool tasks have no thread of their own,a future that
+		 * powers its own task holds no entries at all.
+		 */
 		QThread * thread_at( std::vector< QThread * >::size_type s )
 		{
-			return m_threads[ s ] ;
+			return s < m_threads.size() ? m_threads[ s ] : nullptr ;
 		}
 		void start()
 		{
@@ -484,11 +837,16 @@ namespace Task
 		}
 		QThread * first_thread()
 		{
-			return m_threads[ 0 ] ;
+			return m_threads.empty() ? nullptr : m_threads[ 0 ] ;
 		}
+		/*
+		 * Futures that manage other futures hold one entry per managed future and the
+		 * entry is null since pool tasks have no thread of their own,a future that
+		 * powers its own task holds no entries at all.
+		 */
 		QThread * thread_at( std::vector< QThread * >::size_type s )
 		{
-			return m_threads[ s ] ;
+			return s < m_threads.size() ? m_threads[ s ] : nullptr ;
 		}
 		void start()
 		{
@@ -644,71 +1002,140 @@ namespace Task
 		/*
 		 * -------------------------Start of internal helper functions-------------------------
 		 */
+		/*
+		 * A helper lives in the thread that created it,the wrapped function runs on the
+		 * pool and the helper is then deleted in its own thread where the destructor
+		 * delivers the result to the registered continuation.
+		 *
+		 * Pool and io lane threads have no event loop and a deleteLater() posted to them
+		 * would never run.A helper created on such a thread is deleted directly instead,
+		 * by the thread that ran the wrapped function,and its continuation runs there.
+		 */
+		static inline bool has_event_loop()
+		{
+			auto m = QThread::currentThread() ;
+
+			if( m->loopLevel() > 0 ){
+
+				return true ;
+			}else{
+				/*
+				 * The main thread may not have entered its event loop yet but it will.
+				 */
+				auto app = QCoreApplication::instance() ;
+
+				return app && app->thread() == m ;
+			}
+		}
 		template< typename T >
-		class ThreadHelper : public QThread
+		class TaskHelper : public QObject
 		{
 		public:
-			ThreadHelper( std::function< T() >&& function ) :
+			TaskHelper( std::function< T() >&& function,bool io ) :
 				m_function( std::move( function ) ),
-				m_future( this,
+				m_io( io ),
+				m_eventLoop( Task::detail::has_event_loop() ),
+				m_future( nullptr,
 					  [ this ](){ this->start() ; },
-					  [ this ](){ this->deleteLater() ; },
-					  [ this ](){ this->deleteLater() ; return m_function() ; } )
+					  [ this ](){ this->finish() ; },
+					  [ this ](){ auto r = m_function() ; this->finish() ; return r ; } )
 			{
-				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
 			}
 			future<T>& Future()
 			{
 				return m_future ;
 			}
 		private:
-			~ThreadHelper()
+			~TaskHelper()
 			{
 				m_future.run( std::move( m_result ) ) ;
 			}
-			void run()
+			void finish()
+			{
+				if( m_eventLoop ){
+
+					this->deleteLater() ;
+				}else{
+					delete this ;
+				}
+			}
+			void start()
 			{
-				m_result = m_function() ;
+				Task::detail::submit( [ this ](){
+
+					m_result = m_function() ;
+
+					if( m_eventLoop ){
+
+						QMetaObject::invokeMethod( this,"deleteLater",Qt::QueuedConnection ) ;
+					}else{
+						delete this ;
+					}
+				},m_io ) ;
 			}
 			std::function< T() > m_function ;
+			bool m_io ;
+			bool m_eventLoop ;
 			future<T> m_future ;
 			T m_result ;
 		};
 
 		template<>
-		class ThreadHelper< void > : public QThread
+		class TaskHelper< void > : public QObject
 		{
 		public:
-			ThreadHelper( std::function< void() >&& function ) :
+			TaskHelper( std::function< void() >&& function,bool io ) :
 				m_function( std::move( function ) ),
-				m_future( this,
+				m_io( io ),
+				m_eventLoop( Task::detail::has_event_loop() ),
+				m_future( nullptr,
 					  [ this ](){ this->start() ; },
-					  [ this ](){ this->deleteLater() ; },
-					  [ this ](){ m_function() ; this->deleteLater() ; } )
+					  [ this ](){ this->finish() ; },
+					  [ this ](){ m_function() ; this->finish() ; } )
 			{
-				connect( this,&QThread::finished,this,&QThread::deleteLater ) ;
 			}
 			future< void >& Future()
 			{
 				return m_future ;
 			}
 		private:
-			~ThreadHelper()
+			~TaskHelper()
 			{
 				m_future.run() ;
 			}
-			void run()
+			void finish()
+			{
+				if( m_eventLoop ){
+
+					this->deleteLater() ;
+				}else{
+					delete this ;
+				}
+			}
+			void start()
 			{
-				m_function() ;
+				Task::detail::submit( [ this ](){
+
+					m_function() ;
+
+					if( m_eventLoop ){
+
+						QMetaObject::invokeMethod( this,"deleteLater",Qt::QueuedConnection ) ;
+					}else{
+						delete this ;
+					}
+				},m_io ) ;
 			}
 			std::function< void() > m_function ;
+			bool m_io ;
+			bool m_eventLoop ;
 			future< void > m_future ;
 		};
 		template< typename Fn >
-		Task::future<typename std::result_of<Fn()>::type>& run( Fn function )
+		Task::future<typename std::result_of<Fn()>::type>& run( Fn function,bool io = false )
 		{
 			using fn_t = typename std::result_of<Fn()>::type ;
-			return ( new ThreadHelper<fn_t>( std::move( function ) ) )->Future() ;
+			return ( new TaskHelper<fn_t>( std::move( function ),io ) )->Future() ;
 		}
 
 		template< typename T >
@@ -797,6 +1224,15 @@ namespace Task
 		return Task::detail::run( std::move( function ) ) ;
 	}
 
+	/*
+	 * Same as above but for functions that spend most of their time blocked.
+	 */
+	template< typename Fn >
+	future<typename std::result_of<Fn()>::type>& run_io( Fn function )
+	{
+		return Task::detail::run( std::move( function ),true ) ;
+	}
+
 	template< typename Fn,typename ... Args >
 	future<typename std::result_of<Fn(Args...)>::type>& run( Fn function,Args ... args )
 	{
@@ -987,7 +1423,7 @@ namespace Task
 							   const QProcessEnvironment& env = QProcessEnvironment(),
 							   std::function< void() > setUp_child_process = [](){} )
 		{
-			return Task::run( [ = ](){
+			return Task::run_io( [ = ](){
 
 				class Process : public QProcess{
 				public:
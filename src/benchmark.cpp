@@ -0,0 +1,314 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * sirikali-benchmark,built when cmake is given -DBENCHMARKS=ON.
+ *
+ * Run it without arguments to run every benchmark or give it the names of the ones
+ * to run.Every benchmark is run a few times and the fastest run is reported.
+ */
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <utility>
+
+#include "mounttable.h"
+#include "processlauncher.h"
+#include "favorites.h"
+#include "settings.h"
+
+template< typename Function >
+static double _time( int rounds,Function&& function )
+{
+	double s = -1 ;
+
+	for( int i = 0 ; i < rounds ; i++ ){
+
+		QElapsedTimer timer ;
+
+		timer.start() ;
+
+		function() ;
+
+		double m = static_cast< double >( timer.nsecsElapsed() ) / 1000000 ;
+
+		if( s < 0 || m < s ){
+
+			s = m ;
+		}
+	}
+
+	return s ;
+}
+
+static void _report( const QString& name,double milliseconds )
+{
+	std::cout << name.toStdString() << ": " << milliseconds << " ms" << std::endl ;
+}
+
+/*
+ * A mountinfo with "lines" lines where one line in a hundred is a fuse mount,the
+ * rest are file systems we do not manage.
+ */
+static QByteArray _mountinfo( int lines )
+{
+	QByteArray s ;
+
+	for( int i = 0 ; i < lines ; i++ ){
+
+		auto n = QByteArray::number( i ) ;
+
+		s += n + " 1 0:" + n + " / " ;
+
+		if( i % 100 == 0 ){
+
+			s += "/home/user/volume\\040" + n + " rw,nosuid,nodev,relatime shared:" + n ;
+			s += " - fuse.gocryptfs /home/user/.cipher\\040" + n ;
+			s += " rw,user_id=1000,group_id=1000,default_permissions\n" ;
+		}else{
+			s += "/var/lib/containers/" + n + " rw,relatime shared:" + n ;
+			s += " - overlay overlay rw,lowerdir=/var/lib/l" + n + ",upperdir=/var/lib/u" + n + "\n" ;
+		}
+	}
+
+	return s ;
+}
+
+static QString _decode( QString e )
+{
+	return e.replace( "\\040"," " ) ;
+}
+
+/*
+ * How mountinfo::unlockedVolumes() used to read the mount table,every line is split
+ * into a list of strings before its file system is looked at.
+ */
+static int _parse_with_split( const QByteArray& data )
+{
+	int found = 0 ;
+
+	for( const auto& it : QString::fromUtf8( data ).split( '\n',QString::SkipEmptyParts ) ){
+
+		const auto k = it.split( ' ',QString::SkipEmptyParts ) ;
+
+		auto m = k.indexOf( "-" ) ;
+
+		if( m == -1 || m + 3 >= k.size() ){
+
+			continue ;
+		}
+
+		const auto& fs = k.at( m + 1 ) ;
+
+		if( fs.startsWith( "fuse." ) || fs.compare( "ecryptfs",Qt::CaseInsensitive ) == 0 ){
+
+			auto volumePath = _decode( k.at( m + 2 ) ) ;
+			auto mountPoint = _decode( k.at( 4 ) ) ;
+
+			if( !volumePath.isEmpty() && !mountPoint.isEmpty() ){
+
+				found++ ;
+			}
+		}
+	}
+
+	return found ;
+}
+
+/*
+ * How mountinfo::unlockedVolumes() reads it now.
+ */
+static int _parse_in_place( const QByteArray& data )
+{
+	int found = 0 ;
+
+	const QByteArray ecryptfs( "ecryptfs" ) ;
+
+	mountTable::parse( data,[ & ]( const mountTable::fields& k ){
+
+		const auto& fs = k.fileSystem ;
+
+		if( fs.startsWith( "fuse.",5 ) || fs.equalsCaseInsensitive( ecryptfs ) ){
+
+			auto volumePath = _decode( k.device.toString() ) ;
+			auto mountPoint = _decode( k.mountPoint.toString() ) ;
+
+			if( !volumePath.isEmpty() && !mountPoint.isEmpty() ){
+
+				found++ ;
+			}
+		}
+	} ) ;
+
+	return found ;
+}
+
+static void _mountinfo_benchmark()
+{
+	for( int lines : { 500,5000,50000 } ){
+
+		const auto data = _mountinfo( lines ) ;
+
+		auto a = QString( "mountinfo,%1 lines,split into lists" ).arg( lines ) ;
+		auto b = QString( "mountinfo,%1 lines,parsed in place" ).arg( lines ) ;
+
+		_report( a,_time( 10,[ & ](){ _parse_with_split( data ) ; } ) ) ;
+		_report( b,_time( 10,[ & ](){ _parse_in_place( data ) ; } ) ) ;
+	}
+}
+
+/*
+ * Programs are started from a process with a large address space,the cost of forking
+ * grows with it while posix_spawn() does not copy it.
+ */
+static void _processes_benchmark()
+{
+	const int launches = 200 ;
+
+	auto _qprocess = [](){
+
+		for( int i = 0 ; i < launches ; i++ ){
+
+			QProcess e ;
+
+			e.start( "/bin/true",QStringList() ) ;
+
+			::Task::process::result( e,-1 ) ;
+		}
+	} ;
+
+	auto _launcher = [](){
+
+		for( int i = 0 ; i < launches ; i++ ){
+
+			processLauncher::run( "/bin/true",QStringList() ) ;
+		}
+	} ;
+
+	auto _run = [ & ]( const QString& e ){
+
+		auto a = QString( "processes,%1 launches of /bin/true%2,QProcess" ).arg( launches ).arg( e ) ;
+		auto b = QString( "processes,%1 launches of /bin/true%2,processLauncher" ).arg( launches ).arg( e ) ;
+
+		_report( a,_time( 3,_qprocess ) ) ;
+		_report( b,_time( 3,_launcher ) ) ;
+	} ;
+
+	_run( QString() ) ;
+
+	std::vector< char > m( 256 * 1024 * 1024,'s' ) ;
+
+	_run( " with 256 MiB resident" ) ;
+}
+
+static const int _favorites_count = 10000 ;
+
+/*
+ * Runs in a process of its own since the layout favorites are read from is picked once
+ * per process.Favorites are moved to the single file store before loading is timed.
+ */
+static void _favorites_store_benchmark( const QString& configPath )
+{
+	qputenv( "XDG_CONFIG_HOME",configPath.toUtf8() ) ;
+
+	settings::instance().backend().setValue( "FavoritesSingleFileStore",true ) ;
+
+	favorites::instance().updateFavorites() ;
+
+	auto a = QString( "favorites,%1 entries,single file store,load" ).arg( _favorites_count ) ;
+
+	_report( a,_time( 1,[](){ favorites::instance().readFavorites() ; } ) ) ;
+}
+
+/*
+ * Settings and favorites go to a temporary folder,the user's own are not touched.
+ */
+static void _favorites_benchmark()
+{
+	QTemporaryDir dir ;
+
+	if( !dir.isValid() ){
+
+		return ;
+	}
+
+	qputenv( "XDG_CONFIG_HOME",dir.path().toUtf8() ) ;
+
+	std::vector< favorites::entry > e ;
+
+	for( int i = 0 ; i < _favorites_count ; i++ ){
+
+		auto n = QString::number( i ) ;
+
+		favorites::entry s( "/home/user/volumes/cipher" + n ) ;
+
+		s.mountPointPath = "/home/user/mnt/volume" + n ;
+		s.idleTimeOut    = "0" ;
+
+		e.emplace_back( std::move( s ) ) ;
+	}
+
+	favorites::instance().add( e ) ;
+
+	auto a = QString( "favorites,%1 entries,one file each,load" ).arg( _favorites_count ) ;
+
+	_report( a,_time( 1,[](){ favorites::instance().readFavorites() ; } ) ) ;
+
+	QProcess::execute( QCoreApplication::applicationFilePath(),{ "--favorites-store",dir.path() } ) ;
+}
+
+int main( int argc,char * argv[] )
+{
+	QCoreApplication app( argc,argv ) ;
+
+	std::vector< std::pair< QString,std::function< void() > > > benchmarks ;
+
+	benchmarks.emplace_back( "mountinfo",_mountinfo_benchmark ) ;
+	benchmarks.emplace_back( "processes",_processes_benchmark ) ;
+	benchmarks.emplace_back( "favorites",_favorites_benchmark ) ;
+
+	auto m = QCoreApplication::arguments().mid( 1 ) ;
+
+	if( m.size() == 2 && m.first() == "--favorites-store" ){
+
+		_favorites_store_benchmark( m.at( 1 ) ) ;
+
+		return 0 ;
+	}
+
+	for( const auto& it : benchmarks ){
+
+		if( m.isEmpty() || m.contains( it.first ) ){
+
+			it.second() ;
+		}
+	}
+
+	return 0 ;
+}
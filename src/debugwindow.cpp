@@ -20,6 +20,7 @@
 #include "debugwindow.h"
 #include "ui_debugwindow.h"
 #include "utility.h"
+#include "task.hpp"
 
 debugWindow::debugWindow( QWidget * parent ) :
 	QWidget( parent ),
@@ -52,6 +53,26 @@ debugWindow::~debugWindow()
 void debugWindow::Show()
 {
 	this->show() ;
+
+	auto s = Task::pool_statistics() ;
+
+	auto a = QString( "Task pool: %1 threads,%2 queued(peak %3),%4 tasks,queue latency %5 ms average,%6 ms maximum" ) ;
+
+	auto b = QString( "Task I/O lane: %1 threads(peak %2),%3 queued,%4 tasks,queue latency %5 ms average,%6 ms maximum" ) ;
+
+	this->UpdateOutPutSlot( a.arg( QString::number( s.workers ),
+				       QString::number( s.queueDepth ),
+				       QString::number( s.peakQueueDepth ),
+				       QString::number( s.tasks ),
+				       QString::number( s.averageLatency,'f',3 ),
+				       QString::number( s.maximumLatency,'f',3 ) ),true ) ;
+
+	this->UpdateOutPutSlot( b.arg( QString::number( s.ioThreads ),
+				       QString::number( s.peakIoThreads ),
+				       QString::number( s.ioQueueDepth ),
+				       QString::number( s.ioTasks ),
+				       QString::number( s.ioAverageLatency,'f',3 ),
+				       QString::number( s.ioMaximumLatency,'f',3 ) ),true ) ;
 }
 
 void debugWindow::Hide()
@@ -32,8 +32,20 @@
 #include "utility.h"
 #include "settings.h"
 #include "win.h"
+#include "processlauncher.h"
 #include "engines/options.h"
 
+#include <QSet>
+#include <QFileInfo>
+
+#include <mutex>
+#include <condition_variable>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <limits.h>
+#endif
+
 static QStringList _search_path( const QStringList& m )
 {
 	const auto a = QDir::homePath().toLatin1() ;
@@ -78,6 +90,226 @@ static bool _has_no_extension( const QString& e )
 	return !e.contains( '.' ) ;
 }
 
+#ifdef Q_OS_LINUX
+
+/*
+ * Remembers where executables were found,or that they were not found,keyed by the
+ * executable name and the list of folders it was looked up in.
+ *
+ * Search folders are watched with inotify and pending events are collected before
+ * every lookup,an entry goes away as soon as a file with its name is created,deleted
+ * or renamed in any of the watched folders.A search folder that does not exist is
+ * covered by a watch on its first parent that does exist and everything is forgotten
+ * when the missing folder below that parent shows up.
+ */
+class executableCache
+{
+public:
+	executableCache() : m_inotify_fd( inotify_init1( IN_NONBLOCK | IN_CLOEXEC ) )
+	{
+	}
+	template< typename Function >
+	QString get( const QString& exe,const QStringList& paths,Function function )
+	{
+		if( m_inotify_fd == -1 ){
+
+			return function().first ;
+		}
+
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->processEvents() ;
+
+		auto key = exe + "\n" + paths.join( "\n" ) ;
+
+		auto it = m_entries.find( key ) ;
+
+		if( it != m_entries.end() ){
+
+			m_statsSaved += it.value().stats ;
+
+			return it.value().path ;
+		}
+
+		this->watch( paths ) ;
+
+		auto m = function() ;
+
+		m_entries.insert( key,{ exe,m.first,m.second } ) ;
+
+		auto a = QString( "Executable \"%1\" resolved to \"%2\",%3 stat() calls saved so far" ) ;
+
+		utility::debug() << a.arg( exe,m.first,QString::number( m_statsSaved ) ) ;
+
+		return m.first ;
+	}
+private:
+	void watch( const QStringList& paths )
+	{
+		auto mask = IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB | IN_ONLYDIR ;
+
+		for( const auto& it : paths ){
+
+			if( it.isEmpty() || m_watchedPaths.contains( it ) ){
+
+				continue ;
+			}
+
+			auto wd = inotify_add_watch( m_inotify_fd,it.toLocal8Bit().constData(),mask ) ;
+
+			if( wd == -1 ){
+
+				this->watchParent( it ) ;
+			}else{
+				m_watchedPaths.insert( it ) ;
+			}
+		}
+	}
+	/*
+	 * Watch the first parent of "path" that exists for the folder below it that
+	 * does not,"/opt/local/bin" is covered by a watch on "/opt" for "local" when
+	 * "/opt/local" is missing.
+	 */
+	void watchParent( const QString& path )
+	{
+		auto e = IN_CREATE | IN_MOVED_TO | IN_ONLYDIR | IN_MASK_ADD ;
+
+		QFileInfo child( QDir::cleanPath( path ) ) ;
+
+		while( !child.isRoot() ){
+
+			auto parent = child.path() ;
+
+			if( parent == child.filePath() ){
+
+				return ;
+			}
+
+			auto wd = inotify_add_watch( m_inotify_fd,parent.toLocal8Bit().constData(),e ) ;
+
+			if( wd != -1 ){
+
+				m_parentWatches[ wd ].insert( child.fileName() ) ;
+
+				return ;
+			}
+
+			child = QFileInfo( parent ) ;
+		}
+	}
+	bool parentCreated( const struct inotify_event * e ) const
+	{
+		if( e->len == 0 || !( e->mask & IN_ISDIR ) ){
+
+			return false ;
+		}
+
+		auto it = m_parentWatches.find( e->wd ) ;
+
+		return it != m_parentWatches.end() && it.value().contains( QString::fromLocal8Bit( e->name ) ) ;
+	}
+	void processEvents()
+	{
+		char buffer[ 16 * ( sizeof( struct inotify_event ) + NAME_MAX + 1 ) ] ;
+
+		while( true ){
+
+			auto s = read( m_inotify_fd,buffer,sizeof( buffer ) ) ;
+
+			if( s <= 0 ){
+
+				break ;
+			}
+
+			const char * it  = buffer ;
+			const char * end = buffer + s ;
+
+			while( it < end ){
+
+				auto e = reinterpret_cast< const struct inotify_event * >( it ) ;
+
+				if( e->mask & IN_Q_OVERFLOW || this->parentCreated( e ) ){
+
+					/*
+					 * A search folder may have just been created.
+					 */
+					this->clear() ;
+
+				}else if( e->len > 0 ){
+
+					this->remove( QString::fromLocal8Bit( e->name ) ) ;
+				}
+
+				it += sizeof( struct inotify_event ) + e->len ;
+			}
+		}
+	}
+	void remove( const QString& exe )
+	{
+		auto it = m_entries.begin() ;
+
+		while( it != m_entries.end() ){
+
+			if( it.value().exe == exe ){
+
+				it = m_entries.erase( it ) ;
+			}else{
+				it++ ;
+			}
+		}
+	}
+	void clear()
+	{
+		for( auto it = m_parentWatches.begin() ; it != m_parentWatches.end() ; it++ ){
+
+			inotify_rm_watch( m_inotify_fd,it.key() ) ;
+		}
+
+		m_parentWatches.clear() ;
+		m_watchedPaths.clear() ;
+		m_entries.clear() ;
+	}
+	struct entry{
+		QString exe ;
+		QString path ;
+		int stats ;
+	} ;
+	std::mutex m_mutex ;
+	int m_inotify_fd ;
+	qint64 m_statsSaved = 0 ;
+	QHash< QString,executableCache::entry > m_entries ;
+	QSet< QString > m_watchedPaths ;
+	QHash< int,QSet< QString > > m_parentWatches ;
+} ;
+
+#else
+
+class executableCache
+{
+public:
+	template< typename Function >
+	QString get( const QString& exe,const QStringList& paths,Function function )
+	{
+		Q_UNUSED( exe )
+		Q_UNUSED( paths )
+
+		return function().first ;
+	}
+} ;
+
+#endif
+
+/*
+ * One cache for the whole process whatever the search paths are,_executableFullPath()
+ * is a template and a static inside it would give each of its callers a cache of its own.
+ */
+static executableCache& _executable_cache()
+{
+	static executableCache cache ;
+
+	return cache ;
+}
+
 template< typename Function >
 static QString _executableFullPath( const QString& f,Function function )
 {
@@ -106,22 +338,29 @@ static QString _executableFullPath( const QString& f,Function function )
 		e += ".exe" ;
 	}
 
-	QString exe ;
+	auto paths = function() ;
 
-	for( const auto& it : function() ){
+	return _executable_cache().get( e,paths,[ & ]()->std::pair< QString,int >{
 
-		if( !it.isEmpty() ){
+		int stats = 0 ;
 
-			exe = it + e ;
+		for( const auto& it : paths ){
 
-			if( QFile::exists( exe ) ){
+			if( !it.isEmpty() ){
+
+				auto exe = it + e ;
+
+				stats++ ;
 
-				return exe ;
+				if( QFile::exists( exe ) ){
+
+					return { exe,stats } ;
+				}
 			}
 		}
-	}
 
-	return QString() ;
+		return { QString(),stats } ;
+	} ) ;
 }
 
 QStringList engines::executableSearchPaths()
@@ -176,16 +415,15 @@ void engines::engine::updateVolumeList( const engines::engine::cmdArgsList& e )
 	Q_UNUSED( e )
 }
 
-QStringList engines::engine::mountInfo( const QStringList& e ) const
+QStringList engines::engine::mountInfo() const
 {
-	Q_UNUSED( e )
 	return {} ;
 }
 
 Task::future< QString >& engines::engine::volumeProperties( const QString& cipherFolder,
 							    const QString& mountPoint ) const
 {
-	return Task::run( [ = ](){
+	return Task::run_io( [ = ](){
 
 		for( const auto& it : this->volumePropertiesCommands() ){
 
@@ -239,6 +477,18 @@ bool engines::engine::unmountVolume( const engines::engine::exe& exe,bool usePol
 	return utility::unwrap( s ).success() ;
 }
 
+std::vector< engines::engine::status > engines::engine::unmountVolumes( const std::vector< engines::engine::unMount >& e ) const
+{
+	std::vector< engines::engine::status > s ;
+
+	for( const auto& it : e ){
+
+		s.emplace_back( this->unmount( it ) ) ;
+	}
+
+	return s ;
+}
+
 engines::engine::status engines::engine::unmount( const engines::engine::unMount& e ) const
 {
 	auto cmd = [ & ]()->engines::engine::exe{
@@ -311,7 +561,10 @@ static engines::engineVersion _installedVersion( const engines::engine& e,
 {
 	const auto& cmd = e.executableFullPath() ;
 
-	const auto r = utility::unwrap( ::Task::process::run( cmd,{ v.versionArgument },-1,{},env ) ) ;
+	const auto r = utility::unwrap( ::Task::run_io( [ & ](){
+
+		return processLauncher::run( cmd,{ v.versionArgument },-1,{},env ) ;
+	} ) ) ;
 
 	const auto m = utility::split( v.readFromStdOut ? r.std_out() : r.std_error(),'\n' ) ;
 
@@ -351,6 +604,150 @@ static engines::engineVersion _installedVersion( const engines::engine& e,
 	return {} ;
 }
 
+/*
+ * Remembers the version of each backend's executable on disk,an entry is only used
+ * while the executable still has the same path,inode,modification time and size.
+ *
+ * Concurrent requests for the same backend wait for the one already running instead
+ * of starting their own process.
+ */
+class versionStore
+{
+public:
+	void setPath( const QString& e )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		m_path = e ;
+	}
+	template< typename Function >
+	engines::engineVersion get( const QString& name,const QString& exe,Function function )
+	{
+		if( exe.isEmpty() ){
+
+			return function() ;
+		}
+
+		auto id = this->identity( exe ) ;
+
+		std::unique_lock< std::mutex > lock( m_mutex ) ;
+
+		this->load() ;
+
+		while( m_running.contains( name ) ){
+
+			m_cv.wait( lock ) ;
+		}
+
+		auto it = m_versions.find( name ) ;
+
+		if( it != m_versions.end() && it.value().first == id ){
+
+			return it.value().second ;
+		}
+
+		m_running.insert( name ) ;
+
+		lock.unlock() ;
+
+		engines::engineVersion m = function() ;
+
+		lock.lock() ;
+
+		m_running.remove( name ) ;
+
+		if( m.valid() ){
+
+			m_versions.insert( name,{ id,m.toString() } ) ;
+
+			this->save() ;
+		}
+
+		lock.unlock() ;
+
+		m_cv.notify_all() ;
+
+		return m ;
+	}
+private:
+	QString identity( const QString& exe )
+	{
+		struct stat st ;
+
+		if( stat( exe.toLocal8Bit().constData(),&st ) == 0 ){
+
+			auto a = QString::number( static_cast< qulonglong >( st.st_ino ) ) ;
+			auto b = QString::number( static_cast< qlonglong >( st.st_mtime ) ) ;
+			auto c = QString::number( static_cast< qlonglong >( st.st_size ) ) ;
+
+			return exe + ":" + a + ":" + b + ":" + c ;
+		}else{
+			return exe ;
+		}
+	}
+	void load()
+	{
+		if( m_loaded || m_path.isEmpty() || !utility::pathExists( m_path ) ){
+
+			return ;
+		}
+
+		m_loaded = true ;
+
+		try{
+			SirikaliJson json( m_path,SirikaliJson::type::PATH,[]( const QString& e ){ Q_UNUSED( e ) } ) ;
+
+			for( const auto& it : json.getStringList( "versions" ) ){
+
+				auto m = it.split( '\n' ) ;
+
+				if( m.size() == 3 ){
+
+					m_versions.insert( m.at( 0 ),{ m.at( 1 ),m.at( 2 ) } ) ;
+				}
+			}
+
+		}catch( ... ){
+
+			utility::debug() << "Failed to read backend versions from: " + m_path ;
+		}
+	}
+	void save()
+	{
+		if( m_path.isEmpty() ){
+
+			return ;
+		}
+
+		QStringList s ;
+
+		for( auto it = m_versions.begin() ; it != m_versions.end() ; it++ ){
+
+			s.append( it.key() + "\n" + it.value().first + "\n" + it.value().second ) ;
+		}
+
+		try{
+			SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+
+			json[ "versions" ] = s ;
+
+			json.toFile( m_path ) ;
+
+		}catch( ... ){
+
+			utility::debug() << "Failed to save backend versions to: " + m_path ;
+		}
+	}
+	std::mutex m_mutex ;
+	std::condition_variable m_cv ;
+	QString m_path ;
+	bool m_loaded = false ;
+	QSet< QString > m_running ;
+	QHash< QString,QPair< QString,QString > > m_versions ;
+} ;
+
+static versionStore _version_store ;
+
 static QProcessEnvironment _set_env( const engines::engine& engine )
 {
 	auto m = utility::systemEnvironment() ;
@@ -369,10 +766,25 @@ engines::engine::engine( engines::engine::BaseOptions o ) :
 	m_Options( std::move( o ) ),
 	m_processEnvironment( _set_env( *this ) ),
 	m_exeFullPath( [ this ](){ return engines::executableFullPath( this->executableName(),*this ) ; } ),
-	m_version( this->name(),[ this ](){ return _installedVersion( *this,m_processEnvironment,m_Options.versionInfo ) ; } )
+	m_version( this->name(),[ this ](){ return this->probeVersion() ; } )
 {
 }
 
+engines::engineVersion engines::engine::probeVersion() const
+{
+	if( m_Options.versionInfo.empty() ){
+
+		return {} ;
+	}
+
+	const auto& exe = this->executableFullPath() ;
+
+	return _version_store.get( this->name(),exe,[ this ](){
+
+		return _installedVersion( *this,m_processEnvironment,m_Options.versionInfo ) ;
+	} ) ;
+}
+
 const QString& engines::engine::executableFullPath() const
 {
 	return m_exeFullPath.get() ;
@@ -742,13 +1154,13 @@ bool engines::atLeastOneDealsWithFiles() const
 	return false ;
 }
 
-QStringList engines::mountInfo( const QStringList& m ) const
+QStringList engines::mountInfo() const
 {
 	QStringList s ;
 
 	for( const auto& e : this->supportedEngines() ){
 
-		s += e->mountInfo( m ) ;
+		s += e->mountInfo() ;
 	}
 
 	return s ;
@@ -823,10 +1235,90 @@ engines::engines()
 
 	custom::addEngines( m_backends ) ;
 
+	_version_store.setPath( settings::instance().ConfigLocation() + "/backendVersions.json" ) ;
+
 	for( size_t i = 1 ; i < m_backends.size() ; i++ ){
 
 		m_backendWrappers.emplace_back( *( m_backends[ i ] ) ) ;
 	}
+
+	this->buildIndex() ;
+}
+
+void engines::warmUpVersions() const
+{
+	/*
+	 * Executable paths are resolved here,on the calling thread,to make sure the
+	 * background tasks only read them.
+	 */
+	for( const auto& it : this->supportedEngines() ){
+
+		const auto& engine = it.get() ;
+
+		if( engine.isInstalled() ){
+
+			/*
+			 * A probe runs the backend and some of them take a while to answer.
+			 */
+			Task::run_io( [ &engine ](){
+
+				engine.probeVersion() ;
+
+			} ).start() ;
+		}
+	}
+}
+
+void engines::buildIndex()
+{
+	auto _add = []( QHash< QString,const engines::engine * >& h,
+			const QString& key,
+			const engines::engine * e ){
+
+		if( !h.contains( key ) ){
+
+			h.insert( key,e ) ;
+		}
+	} ;
+
+	for( size_t i = 1 ; i < m_backends.size() ; i++ ){
+
+		const auto m = m_backends[ i ].get() ;
+
+		m_backendIndex.insert( m,i ) ;
+
+		for( const auto& it : m->names() ){
+
+			_add( m_byName,it.toCaseFolded(),m ) ;
+		}
+
+		for( const auto& it : m->fuseNames() ){
+
+			_add( m_byFuseName,it.toCaseFolded(),m ) ;
+		}
+
+		for( const auto& it : m->configFileNames() ){
+
+			m_configFileNames.emplace_back( it,m ) ;
+
+			if( it.contains( '/' ) ){
+
+				m_nestedConfigFileNames.emplace_back( it,m ) ;
+			}else{
+				_add( m_byConfigFileName,it,m ) ;
+			}
+		}
+
+		for( const auto& it : m->fileExtensions() ){
+
+			m_fileExtensions.emplace_back( it,m ) ;
+		}
+
+		if( m->configFileNames().isEmpty() ){
+
+			m_noConfigFileBackends.emplace_back( m ) ;
+		}
+	}
 }
 
 template< typename Compare,typename listSource >
@@ -891,56 +1383,188 @@ engines::engine::ownsCipherFolder engines::engine::ownsCipherPath( const QString
 	}
 }
 
-engines::engineWithPaths engines::getByPaths( const QString& cipherPath,
+const engines::engine * engines::lowestIndex( const engines::engine * a,
+					      const engines::engine * b ) const
+{
+	if( a == nullptr ){
+
+		return b ;
+
+	}else if( b == nullptr ){
+
+		return a ;
+
+	}else if( m_backendIndex.value( a ) < m_backendIndex.value( b ) ){
+
+		return a ;
+	}else{
+		return b ;
+	}
+}
+
+engines::engineWithPaths engines::getByPaths( size_t index,
+					      const QString& cipherPath,
 					      const QString& configFilePath ) const
 {
-	for( size_t i = 1 ; i < m_backends.size() ; i++ ){
+	/*
+	 * Backends without config files can only be identified by asking them,they are
+	 * asked in their original order as long as they come before "index".
+	 *
+	 * Backend at "index" was identified through the lookup tables and it owns
+	 * "cipherPath" with "configFilePath" as its config file.
+	 */
+	for( const auto& it : m_noConfigFileBackends ){
 
-		const auto& m = m_backends[ i ] ;
+		if( m_backendIndex.value( it ) >= index ){
+
+			break ;
+		}
 
-		auto mm = m->ownsCipherPath( cipherPath,configFilePath ) ;
+		auto mm = it->ownsCipherPath( cipherPath,configFilePath ) ;
 
 		if( mm.yes ){
 
-			return { *m,std::move( mm ) } ;
+			return { *it,std::move( mm ) } ;
 		}
 	}
 
-	return {} ;
+	if( index < m_backends.size() ){
+
+		return { *m_backends[ index ],{ true,cipherPath,configFilePath } } ;
+	}else{
+		return {} ;
+	}
 }
 
-const engines::engine& engines::getByFuseName( const QString& e ) const
+engines::engineWithPaths engines::getByPaths( const QString& cipherPath,
+					      const QString& configFilePath ) const
 {
-	auto cmp = [ & ]( const QString& s ){ return !e.compare( s,Qt::CaseInsensitive ) ; } ;
+	const engines::engine * engine = nullptr ;
 
-	for( size_t i = 1 ; i < m_backends.size() ; i++ ){
+	auto _index = [ & ](){
 
-		const auto& m = m_backends[ i ] ;
+		if( engine ){
 
-		if( _found( m->fuseNames(),cmp ) ){
+			return m_backendIndex.value( engine ) ;
+		}else{
+			return m_backends.size() ;
+		}
+	} ;
+
+	auto s = cipherPath.indexOf( ' ' ) ;
+
+	if( s != -1 ){
+
+		/*
+		 * Paths like "sshfs user@host:/path" carry the name of their backend.
+		 */
+		auto m = m_byName.value( cipherPath.mid( 0,s ).toCaseFolded() ) ;
 
-			return *m ;
+		if( m && cipherPath.startsWith( m->name() + " ",Qt::CaseInsensitive ) ){
+
+			auto mm = m->ownsCipherPath( cipherPath,configFilePath ) ;
+
+			if( mm.yes ){
+
+				return { *m,std::move( mm ) } ;
+			}
 		}
 	}
 
-	return this->getUnKnown() ;
-}
+	if( utility::pathIsFile( cipherPath ) ){
 
-const engines::engine& engines::getByName( const QString& e ) const
-{
-	auto cmp = [ & ]( const QString& s ){ return !e.compare( s,Qt::CaseInsensitive ) ; } ;
+		for( const auto& it : m_fileExtensions ){
 
-	for( size_t i = 1 ; i < m_backends.size() ; i++ ){
+			if( cipherPath.endsWith( it.first ) ){
+
+				engine = it.second ;
+				break ;
+			}
+		}
+
+	}else if( configFilePath.isEmpty() ){
 
-		const auto& m = m_backends[ i ] ;
+		/*
+		 * One listing of the folder instead of one stat per backend per config file name.
+		 */
+		auto flags = QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot ;
 
-		if( _found( m->names(),cmp ) ){
+		for( const auto& it : QDir( cipherPath ).entryList( flags ) ){
 
-			return *m ;
+			engine = this->lowestIndex( engine,m_byConfigFileName.value( it ) ) ;
+		}
+
+		for( const auto& it : m_nestedConfigFileNames ){
+
+			if( utility::pathExists( cipherPath + "/" + it.first ) ){
+
+				engine = this->lowestIndex( engine,it.second ) ;
+			}
+		}
+	}else{
+		const engines::engine * byConfigName = nullptr ;
+		const engines::engine * byPrefix = nullptr ;
+
+		for( const auto& it : m_configFileNames ){
+
+			if( configFilePath.endsWith( it.first ) ){
+
+				byConfigName = this->lowestIndex( byConfigName,it.second ) ;
+			}
+		}
+
+		QString prefix ;
+
+		auto e = configFilePath.indexOf( "]]]" ) ;
+
+		if( configFilePath.startsWith( "[[[" ) && e != -1 ){
+
+			auto m = m_byName.value( configFilePath.mid( 3,e - 3 ).toCaseFolded() ) ;
+
+			if( m ){
+
+				prefix = "[[[" + m->name() + "]]]" ;
+
+				if( configFilePath.startsWith( prefix ) ){
+
+					byPrefix = m ;
+				}
+			}
+		}
+
+		engine = this->lowestIndex( byConfigName,byPrefix ) ;
+
+		if( engine && engine != byConfigName ){
+
+			return this->getByPaths( _index(),cipherPath,configFilePath.mid( prefix.size() ) ) ;
 		}
 	}
 
-	return this->getUnKnown() ;
+	return this->getByPaths( _index(),cipherPath,configFilePath ) ;
+}
+
+const engines::engine& engines::getByFuseName( const QString& e ) const
+{
+	auto m = m_byFuseName.value( e.toCaseFolded() ) ;
+
+	if( m ){
+
+		return *m ;
+	}else{
+		return this->getUnKnown() ;
+	}
+}
+
+const engines::engine& engines::getByName( const QString& e ) const
+{
+	auto m = m_byName.value( e.toCaseFolded() ) ;
+
+	if( m ){
+
+		return *m ;
+	}else{
+		return this->getUnKnown() ;
+	}
 }
 
 engines::engineWithPaths::engineWithPaths()
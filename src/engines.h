@@ -28,6 +28,7 @@
 #include <QString>
 #include <QStringList>
 #include <QWidget>
+#include <QHash>
 
 #include "volumeinfo.h"
 #include "favorites.h"
@@ -97,7 +98,7 @@ public:
 
 			        m_unset = false ;
 
-				m_variable = utility::unwrap( Task::run( [ this ]{ return m_function() ; } ) ) ;
+				m_variable = utility::unwrap( Task::run_io( [ this ]{ return m_function() ; } ) ) ;
 			}
 
 			return m_variable ;
@@ -550,6 +551,7 @@ public:
 		const QStringList& windowsUnMountCommand() const ;
 
 		const engines::version& installedVersion() const ;
+		engines::engineVersion probeVersion() const ;
 
 		const QString& executableFullPath() const ;
 		const QString& minimumVersion() const ;
@@ -575,13 +577,18 @@ public:
 
 		virtual void updateVolumeList( const engines::engine::cmdArgsList& ) const ;
 
-		virtual QStringList mountInfo( const QStringList& ) const ;
+		virtual QStringList mountInfo() const ;
 
 		virtual Task::future< QString >& volumeProperties( const QString& cipherFolder,
 								   const QString& mountPoint ) const ;
 
 		virtual engines::engine::status unmount( const engines::engine::unMount& ) const ;
 
+		/*
+		 * Unmount several volumes of this engine,statuses come back in the same order.
+		 */
+		virtual std::vector< engines::engine::status > unmountVolumes( const std::vector< engines::engine::unMount >& ) const ;
+
 		virtual bool requiresAPassword( const engines::engine::cmdArgsList& ) const ;
 
 		virtual bool takesTooLongToUnlock() const ;
@@ -743,7 +750,8 @@ public:
 	engines() ;
 	static const engines& instance() ;
 	bool atLeastOneDealsWithFiles() const ;
-	QStringList mountInfo( const QStringList& ) const ;
+	void warmUpVersions() const ;
+	QStringList mountInfo() const ;
 	QStringList enginesWithNoConfigFile() const ;
 	QStringList enginesWithConfigFile() const ;
 	const std::vector< engines::engine::Wrapper >& supportedEngines() const ;
@@ -785,8 +793,27 @@ public:
 	const engine& getByName( const QString& e ) const ;
 	const engine& getByFuseName( const QString& e ) const ;
 private:
+	void buildIndex() ;
+	engines::engineWithPaths getByPaths( size_t index,
+					     const QString& cipherPath,
+					     const QString& configPath ) const ;
+	const engines::engine * lowestIndex( const engines::engine * a,
+					     const engines::engine * b ) const ;
 	std::vector< std::unique_ptr< engines::engine > > m_backends ;
 	std::vector< engines::engine::Wrapper > m_backendWrappers ;
+	/*
+	 * Lookup tables built once in the constructor,keys in the first two tables are
+	 * case folded.A name that appears in more than one backend maps to the first
+	 * backend that has it,matching the order in which backends used to be searched.
+	 */
+	QHash< QString,const engines::engine * > m_byName ;
+	QHash< QString,const engines::engine * > m_byFuseName ;
+	QHash< QString,const engines::engine * > m_byConfigFileName ;
+	QHash< const engines::engine *,size_t > m_backendIndex ;
+	std::vector< std::pair< QString,const engines::engine * > > m_configFileNames ;
+	std::vector< std::pair< QString,const engines::engine * > > m_nestedConfigFileNames ;
+	std::vector< std::pair< QString,const engines::engine * > > m_fileExtensions ;
+	std::vector< const engines::engine * > m_noConfigFileBackends ;
 };
 
 #endif
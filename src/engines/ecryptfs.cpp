@@ -155,6 +155,82 @@ engines::engine::status ecryptfs::unmount( const engines::engine::unMount& e ) c
 	}
 }
 
+/*
+ * Through siripolkit,all volumes are unmounted with one request that runs them in
+ * parallel and the ones that failed are retried together.
+ */
+std::vector< engines::engine::status > ecryptfs::unmountVolumes( const std::vector< engines::engine::unMount >& e ) const
+{
+	if( !utility::useSiriPolkit() || e.size() < 2 ){
+
+		return engines::engine::unmountVolumes( e ) ;
+	}
+
+	const auto& su = m_exeSUFullPath.get() ;
+
+	if( su.isEmpty() ){
+
+		return engines::engine::unmountVolumes( e ) ;
+	}
+
+	std::vector< engines::engine::status > s( e.size(),engines::engine::status::failedToUnMount ) ;
+
+	std::vector< size_t > remaining ;
+
+	int numberOfAttempts = 1 ;
+
+	for( size_t i = 0 ; i < e.size() ; i++ ){
+
+		remaining.emplace_back( i ) ;
+
+		numberOfAttempts = qMax( numberOfAttempts,e[ i ].numberOfAttempts ) ;
+	}
+
+	auto exe = this->executableFullPath() ;
+
+	for( int attempt = 0 ; attempt < numberOfAttempts ; attempt++ ){
+
+		if( attempt > 0 ){
+
+			utility::Task::waitForOneSecond() ;
+		}
+
+		QStringList commands ;
+
+		for( auto it : remaining ){
+
+			commands.append( exe + " -k " + e[ it ].cipherFolder ) ;
+		}
+
+		auto r = utility::polkitBatch( su,commands ) ;
+
+		std::vector< size_t > failed ;
+
+		for( size_t i = 0 ; i < remaining.size() ; i++ ){
+
+			auto m = remaining[ i ] ;
+
+			if( i < r.size() && r[ i ].success() ){
+
+				s[ m ] = engines::engine::status::success ;
+
+			}else if( attempt + 1 < e[ m ].numberOfAttempts ){
+
+				failed.emplace_back( m ) ;
+			}
+		}
+
+		remaining = std::move( failed ) ;
+
+		if( remaining.empty() ){
+
+			break ;
+		}
+	}
+
+	return s ;
+}
+
 engines::engine::args ecryptfs::command( const QByteArray& password,
 					 const engines::engine::cmdArgsList& args,
 					 bool create ) const
@@ -31,6 +31,8 @@ struct ecryptfs : public engines::engine
 
 	engines::engine::status unmount( const engines::engine::unMount& e ) const override ;
 
+	std::vector< engines::engine::status > unmountVolumes( const std::vector< engines::engine::unMount >& ) const override ;
+
 	engines::engine::status errorCode( const QString& e,int s ) const override ;
 
 	engines::engine::args command( const QByteArray& password,
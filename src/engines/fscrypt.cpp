@@ -26,7 +26,6 @@
 #include "options.h"
 
 struct mountInfo{
-	const QStringList& mountInfo ;
 	const QStringList& mountedVolumes ;
 	const QStringList& fuseNames ;
 	const QString& exe ;
@@ -61,24 +60,32 @@ static QStringList _encrypted_volumes( const QString& list )
 	return l ;
 }
 
-static QString _get_fs_mode( const QStringList& s,const QString& m )
-{
-	for( const auto& it : s ){
+#ifdef Q_OS_LINUX
 
-		auto a = utility::split( it,' ' ) ;
+#include <sys/statvfs.h>
 
-		if( a.size() > 6 ){
+static QString _get_fs_mode( const QString& m )
+{
+	struct statvfs e ;
 
-			if( m.startsWith( a.at( 4 ) ) ){
+	if( statvfs( m.toLocal8Bit().constData(),&e ) == 0 ){
 
-				return a.at( 5 ).mid( 0,2 ) ;
-			}
-		}
+		return e.f_flag & ST_RDONLY ? "ro" : "rw" ;
+	}else{
+		return "-" ;
 	}
+}
+
+#else
 
+static QString _get_fs_mode( const QString& m )
+{
+	Q_UNUSED( m )
 	return "-" ;
 }
 
+#endif
+
 static utility::Task _run( const QString& cmd,const QStringList& list )
 {
 	utility::debug() << cmd << list ;
@@ -164,7 +171,7 @@ static QStringList _mountInfo( const mountInfo& e,Function removeEntry )
 
 		if( !s.isEmpty() ){
 
-			auto md = _get_fs_mode( e.mountInfo,it ) ;
+			auto md = _get_fs_mode( tt ) ;
 
 			if( s == "Yes" ){
 
@@ -360,7 +367,7 @@ engines::engine::status fscrypt::unmount( const engines::engine::unMount& e ) co
 	return engines::engine::status::failedToUnMount ;
 }
 
-QStringList fscrypt::mountInfo( const QStringList& a ) const
+QStringList fscrypt::mountInfo() const
 {
 	auto exe = this->executableFullPath() ;
 
@@ -372,7 +379,7 @@ QStringList fscrypt::mountInfo( const QStringList& a ) const
 	auto list = m_unlockedVolumeManager.getList() ;
 	const auto& names = this->fuseNames() ;
 
-	return _mountInfo( { a,list,names,exe },[ this ]( const QString& e ){
+	return _mountInfo( { list,names,exe },[ this ]( const QString& e ){
 
 		m_unlockedVolumeManager.removeEntry( e ) ;
 	} ) ;
@@ -425,7 +432,7 @@ void fscrypt::updateVolumeList( const engines::engine::cmdArgsList& e ) const
 Task::future< QString >& fscrypt::volumeProperties( const QString& cipherFolder,
 						    const QString& mountPoint ) const
 {
-	return Task::run( [ = ](){
+	return Task::run_io( [ = ](){
 
 		return _volume_properties( cipherFolder,mountPoint,this->executableFullPath() ) ;
 	} ) ;
@@ -0,0 +1,262 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "eventmonitor.h"
+
+#ifdef Q_OS_LINUX
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+
+static_assert( eventMonitor::readable == EPOLLIN,"" ) ;
+static_assert( eventMonitor::priority == EPOLLPRI,"" ) ;
+
+eventMonitor::eventMonitor() :
+	m_epoll_fd( epoll_create1( EPOLL_CLOEXEC ) ),
+	m_event_fd( eventfd( 0,EFD_CLOEXEC | EFD_NONBLOCK ) )
+{
+	if( m_epoll_fd != -1 && m_event_fd != -1 ){
+
+		struct epoll_event e ;
+
+		e.events  = EPOLLIN ;
+		e.data.fd = m_event_fd ;
+
+		epoll_ctl( m_epoll_fd,EPOLL_CTL_ADD,m_event_fd,&e ) ;
+	}
+}
+
+eventMonitor::~eventMonitor()
+{
+	if( m_event_fd != -1 ){
+
+		close( m_event_fd ) ;
+	}
+
+	if( m_epoll_fd != -1 ){
+
+		close( m_epoll_fd ) ;
+	}
+}
+
+bool eventMonitor::valid() const
+{
+	return m_epoll_fd != -1 && m_event_fd != -1 ;
+}
+
+bool eventMonitor::add( int fd,uint32_t events,eventMonitor::function function )
+{
+	if( !this->valid() || fd == -1 ){
+
+		return false ;
+	}
+
+	std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+	struct epoll_event e ;
+
+	e.events  = events ;
+	e.data.fd = fd ;
+
+	if( epoll_ctl( m_epoll_fd,EPOLL_CTL_ADD,fd,&e ) == 0 ){
+
+		m_functions[ fd ] = std::move( function ) ;
+
+		return true ;
+	}else{
+		return false ;
+	}
+}
+
+void eventMonitor::remove( int fd )
+{
+	if( !this->valid() ){
+
+		return ;
+	}
+
+	std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+	epoll_ctl( m_epoll_fd,EPOLL_CTL_DEL,fd,nullptr ) ;
+
+	m_functions.erase( fd ) ;
+}
+
+void eventMonitor::run()
+{
+	if( !this->valid() ){
+
+		return ;
+	}
+
+	struct epoll_event events[ 16 ] ;
+
+	while( true ){
+
+		auto s = epoll_wait( m_epoll_fd,events,16,-1 ) ;
+
+		if( s == -1 ){
+
+			if( errno == EINTR ){
+
+				continue ;
+			}else{
+				return ;
+			}
+		}
+
+		for( int i = 0 ; i < s ; i++ ){
+
+			const auto& it = events[ i ] ;
+
+			if( it.data.fd == m_event_fd ){
+
+				uint64_t m ;
+
+				if( read( m_event_fd,&m,sizeof( m ) ) ){}
+
+				return ;
+			}
+
+			/*
+			 * Take a copy of the callback to allow it to add or remove file
+			 * descriptors,including its own.
+			 */
+			auto function = [ & ]()->eventMonitor::function{
+
+				std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+				auto m = m_functions.find( it.data.fd ) ;
+
+				if( m == m_functions.end() ){
+
+					return {} ;
+				}else{
+					return m->second ;
+				}
+			}() ;
+
+			if( function ){
+
+				function( it.events ) ;
+			}
+		}
+	}
+}
+
+void eventMonitor::stop()
+{
+	if( m_event_fd != -1 ){
+
+		uint64_t m = 1 ;
+
+		if( write( m_event_fd,&m,sizeof( m ) ) ){}
+	}
+}
+
+int eventMonitor::createTimer()
+{
+	return timerfd_create( CLOCK_MONOTONIC,TFD_CLOEXEC | TFD_NONBLOCK ) ;
+}
+
+void eventMonitor::armTimer( int fd,int milliseconds )
+{
+	struct itimerspec e = {} ;
+
+	if( milliseconds <= 0 ){
+
+		/*
+		 * A zero value disarms the timer,expire as soon as possible instead.
+		 */
+		e.it_value.tv_nsec = 1 ;
+	}else{
+		e.it_value.tv_sec  = milliseconds / 1000 ;
+		e.it_value.tv_nsec = ( milliseconds % 1000 ) * 1000000 ;
+	}
+
+	timerfd_settime( fd,0,&e,nullptr ) ;
+}
+
+void eventMonitor::disarmTimer( int fd )
+{
+	struct itimerspec e = {} ;
+
+	timerfd_settime( fd,0,&e,nullptr ) ;
+
+	uint64_t m ;
+
+	if( read( fd,&m,sizeof( m ) ) ){}
+}
+
+#else
+
+eventMonitor::eventMonitor() : m_epoll_fd( -1 ),m_event_fd( -1 )
+{
+}
+
+eventMonitor::~eventMonitor()
+{
+}
+
+bool eventMonitor::valid() const
+{
+	return false ;
+}
+
+bool eventMonitor::add( int fd,uint32_t events,eventMonitor::function function )
+{
+	Q_UNUSED( fd )
+	Q_UNUSED( events )
+	Q_UNUSED( function )
+	return false ;
+}
+
+void eventMonitor::remove( int fd )
+{
+	Q_UNUSED( fd )
+}
+
+void eventMonitor::run()
+{
+}
+
+void eventMonitor::stop()
+{
+}
+
+int eventMonitor::createTimer()
+{
+	return -1 ;
+}
+
+void eventMonitor::armTimer( int fd,int milliseconds )
+{
+	Q_UNUSED( fd )
+	Q_UNUSED( milliseconds )
+}
+
+void eventMonitor::disarmTimer( int fd )
+{
+	Q_UNUSED( fd )
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_MONITOR_H
+#define EVENT_MONITOR_H
+
+#include <QtGlobal>
+
+#include <functional>
+#include <mutex>
+#include <map>
+#include <cstdint>
+
+/*
+ * A single thread event loop built on top of epoll.
+ *
+ * File descriptors can be added and removed at any time and from any thread,the
+ * callback registered with a file descriptor is called from the thread that called
+ * run() every time the file descriptor becomes ready.
+ *
+ * stop() wakes the loop up through an eventfd and makes run() return,this is the only
+ * supported way of stopping it.
+ *
+ * On platforms without epoll,every method does nothing and run() returns immediately.
+ */
+class eventMonitor
+{
+public:
+	using function = std::function< void( uint32_t events ) > ;
+
+	/*
+	 * Same values as EPOLLIN and EPOLLPRI,they are here to allow callers to
+	 * build on platforms without epoll.
+	 */
+	enum eventType : uint32_t { readable = 0x001,priority = 0x002 } ;
+
+	eventMonitor() ;
+	eventMonitor( const eventMonitor& ) = delete ;
+	eventMonitor& operator=( const eventMonitor& ) = delete ;
+	~eventMonitor() ;
+
+	bool valid() const ;
+	bool add( int fd,uint32_t events,eventMonitor::function ) ;
+	void remove( int fd ) ;
+	void run() ;
+	void stop() ;
+
+	/*
+	 * Create a one shot timer file descriptor and arm/disarm it,it is to be used
+	 * with add() to get a callback after a timeout.
+	 */
+	static int createTimer() ;
+	static void armTimer( int fd,int milliseconds ) ;
+	static void disarmTimer( int fd ) ;
+private:
+	int m_epoll_fd ;
+	int m_event_fd ;
+	std::mutex m_mutex ;
+	std::map< int,eventMonitor::function > m_functions ;
+} ;
+
+#endif
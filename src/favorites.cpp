@@ -22,11 +22,29 @@
 #include "utility.h"
 #include "settings.h"
 #include "crypto.h"
+#include "pathtrie.h"
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
 #include <QCryptographicHash>
 
+#include <map>
+#include <mutex>
+
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <limits.h>
+#endif
+
+#ifndef Q_OS_WIN
+#include <unistd.h>
+#endif
+
 static utility::qstring_result _config_path()
 {
 	QString m = settings::instance().ConfigLocation() + "/favorites/" ;
@@ -69,7 +87,7 @@ static QString _create_path( const favorites::entry& e )
 	}
 }
 
-static void _move_favorites_to_new_system( const QStringList& m )
+static favorites::entry _move_favorites_to_new_system( const QStringList& m )
 {
 	favorites::entry s ;
 
@@ -120,7 +138,7 @@ static void _move_favorites_to_new_system( const QStringList& m )
 	s.mountOptions.replace( "-SiriKaliVolumeNeedNoPassword","" ) ;
 	s.mountOptions.replace( "-SiriKaliReverseMode","" ) ;
 
-	favorites::instance().add( s ) ;
+	return s ;
 }
 
 static void _log_error( const QString& msg,const QString& path )
@@ -130,100 +148,809 @@ static void _log_error( const QString& msg,const QString& path )
 	utility::debug::showDebugWindow( msg + a ) ;
 }
 
-utility2::result< favorites::entry > favorites::readFavoriteByPath( const QString& path ) const
+static favorites::entry _read_entry( SirikaliJson& json )
+{
+	favorites::entry m ;
+
+	m.reverseMode          = json.getBool( "reverseMode" ) ;
+	m.volumeNeedNoPassword = json.getBool( "volumeNeedNoPassword" ) ;
+	m.volumePath           = json.getString( "volumePath" ) ;
+	m.mountPointPath       = json.getString( "mountPointPath" ) ;
+	m.configFilePath       = json.getString( "configFilePath" ) ;
+	m.idleTimeOut          = json.getString( "idleTimeOut" ) ;
+	m.mountOptions         = json.getString( "mountOptions" ) ;
+	m.preMountCommand      = json.getString( "preMountCommand" ) ;
+	m.postMountCommand     = json.getString( "postMountCommand" ) ;
+	m.preUnmountCommand    = json.getString( "preUnmountCommand" ) ;
+	m.postUnmountCommand   = json.getString( "postUnmountCommand" ) ;
+
+	m.keyFile              = json.getString( "keyFilePath" ) ;
+
+	favorites::triState::readTriState( json,m.readOnlyMode,"mountReadOnly" ) ;
+	favorites::triState::readTriState( json,m.autoMount,"autoMountVolume" ) ;
+
+	return m ;
+}
+
+static void _write_entry( SirikaliJson& json,const favorites::entry& e )
+{
+	json[ "volumePath" ]           = e.volumePath ;
+	json[ "mountPointPath" ]       = e.mountPointPath ;
+	json[ "configFilePath" ]       = e.configFilePath ;
+	json[ "keyFilePath" ]          = e.keyFile ;
+	json[ "idleTimeOut" ]          = e.idleTimeOut ;
+	json[ "mountOptions" ]         = e.mountOptions ;
+	json[ "preMountCommand" ]      = e.preMountCommand ;
+	json[ "postMountCommand" ]     = e.postMountCommand ;
+	json[ "preUnmountCommand" ]    = e.preUnmountCommand ;
+	json[ "postUnmountCommand" ]   = e.postUnmountCommand ;
+	json[ "reverseMode" ]          = e.reverseMode ;
+	json[ "volumeNeedNoPassword" ] = e.volumeNeedNoPassword ;
+
+	favorites::triState::writeTriState( json,e.readOnlyMode,"mountReadOnly" ) ;
+	favorites::triState::writeTriState( json,e.autoMount,"autoMountVolume" ) ;
+}
+
+static utility2::result< favorites::entry > _read_favorite( const QString& path )
 {
 	try {
 		SirikaliJson json( path,
 				   SirikaliJson::type::PATH,
 				   []( const QString& e ){ utility::debug() << e ; } ) ;
 
-		favorites::entry m ;
+		return _read_entry( json ) ;
 
-		m.reverseMode          = json.getBool( "reverseMode" ) ;
-		m.volumeNeedNoPassword = json.getBool( "volumeNeedNoPassword" ) ;
-		m.volumePath           = json.getString( "volumePath" ) ;
-		m.mountPointPath       = json.getString( "mountPointPath" ) ;
-		m.configFilePath       = json.getString( "configFilePath" ) ;
-		m.idleTimeOut          = json.getString( "idleTimeOut" ) ;
-		m.mountOptions         = json.getString( "mountOptions" ) ;
-		m.preMountCommand      = json.getString( "preMountCommand" ) ;
-		m.postMountCommand     = json.getString( "postMountCommand" ) ;
-		m.preUnmountCommand    = json.getString( "preUnmountCommand" ) ;
-		m.postUnmountCommand   = json.getString( "postUnmountCommand" ) ;
+	}catch( const std::exception& e ){
 
-		m.keyFile              = json.getString( "keyFilePath" ) ;
+		_log_error( e.what(),path ) ;
 
-		favorites::triState::readTriState( json,m.readOnlyMode,"mountReadOnly" ) ;
-		favorites::triState::readTriState( json,m.autoMount,"autoMountVolume" ) ;
+	}catch( ... ){
 
-		return m ;
+		_log_error( "Unknown error has occured",path ) ;
+	}
+
+	return {} ;
+}
+
+static favorites::error _add_file( const favorites::entry& e )
+{
+	auto a = _create_path( e ) ;
+
+	if( a.isEmpty() ){
+
+		return favorites::error::FAILED_TO_CREATE_ENTRY ;
+	}
+
+	try{
+		SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+
+		_write_entry( json,e ) ;
+
+		if( utility::pathExists( a ) ){
+
+			return favorites::error::ENTRY_ALREADY_EXISTS ;
+		}else{
+			if( json.toFile( a ) ){
+
+				return favorites::error::SUCCESS ;
+			}else{
+				return favorites::error::FAILED_TO_CREATE_ENTRY ;
+			}
+		}
 
 	}catch( const std::exception& e ){
 
-		_log_error( e.what(),path ) ;
+		_log_error( e.what(),a ) ;
 
 	}catch( ... ){
 
-		_log_error( "Unknown error has occured",path ) ;
+		_log_error( "Unknown error has occured",a ) ;
 	}
 
-	return {} ;
+	return favorites::error::FAILED_TO_CREATE_ENTRY ;
 }
 
-std::vector<favorites::entry> favorites::readFavorites() const
+/*
+ * All favorites in one file,"favorites.store",with changes made after it was written
+ * appended to "favorites.journal".
+ *
+ * Both files hold one favorite per line as compact JSON,a journal line also says if
+ * its favorite was added or removed.Loading maps the store file and replays the journal
+ * over it.Once the journal holds more lines than there are favorites,the two are folded
+ * into a new store file that is written next to the old one and renamed over it,the
+ * journal is emptied after that.
+ */
+class favoritesStore
 {
-	const auto m = _config_path() ;
+public:
+	favoritesStore() :
+		m_storePath( settings::instance().ConfigLocation() + "/favorites.store" ),
+		m_journalPath( settings::instance().ConfigLocation() + "/favorites.journal" )
+	{
+	}
+	bool exists() const
+	{
+		return utility::pathExists( m_storePath ) ;
+	}
+	/*
+	 * Favorites come back keyed by their file names in the per file layout.
+	 */
+	std::map< QString,favorites::entry > load()
+	{
+		std::map< QString,favorites::entry > s ;
 
-	if( !m.has_value() ){
+		this->read( m_storePath,[ & ]( SirikaliJson& json ){
 
-		return {} ;
+			auto e = _read_entry( json ) ;
+
+			s[ _create_path( QString(),e ) ] = std::move( e ) ;
+		} ) ;
+
+		m_journalLines = 0 ;
+
+		this->read( m_journalPath,[ & ]( SirikaliJson& json ){
+
+			auto e = _read_entry( json ) ;
+
+			auto name = _create_path( QString(),e ) ;
+
+			if( json.getString( "journalOperation" ) == "remove" ){
+
+				s.erase( name ) ;
+			}else{
+				s[ name ] = std::move( e ) ;
+			}
+
+			m_journalLines++ ;
+		} ) ;
+
+		m_stamp = this->stamp() ;
+
+		return s ;
 	}
+	/*
+	 * All entries go to the journal with one write.
+	 */
+	bool append( const std::vector< favorites::entry >& e,bool add )
+	{
+		QByteArray s ;
 
-	const auto& a = m.value() ;
+		try{
+			for( const auto& it : e ){
 
-	const auto s = QDir( a ).entryList( QDir::Filter::Files | QDir::Filter::Hidden ) ;
+				SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
 
-	std::vector< favorites::entry > e ;
+				_write_entry( json,it ) ;
 
-	for( const auto& it : s ){
+				json[ "journalOperation" ] = add ? "add" : "remove" ;
 
-		auto mm = this->readFavoriteByPath( a + it ) ;
+				s += json.structure( -1 ) + "\n" ;
+			}
+
+		}catch( const std::exception& e ){
 
-		if( mm ){
+			_log_error( e.what(),m_journalPath ) ;
 
-			e.emplace_back( mm.RValue() ) ;
+			return false ;
 		}
+
+		QFile file( m_journalPath ) ;
+
+		if( !file.open( QIODevice::ReadWrite | QIODevice::Append ) ){
+
+			return false ;
+		}
+
+		if( file.size() > 0 && file.seek( file.size() - 1 ) && file.read( 1 ) != "\n" ){
+
+			/*
+			 * The journal ends with a line cut short by a crash,drop it or our first
+			 * line would be glued to it and both would be lost on the next load.
+			 */
+			file.seek( 0 ) ;
+
+			auto m = file.readAll() ;
+
+			if( !file.resize( m.lastIndexOf( '\n' ) + 1 ) ){
+
+				return false ;
+			}
+		}
+
+		auto r = file.write( s ) == s.size() && file.flush() ;
+#ifndef Q_OS_WIN
+		if( r && fsync( file.handle() ) != 0 ){
+
+			r = false ;
+		}
+#endif
+		file.close() ;
+
+		m_journalLines += e.size() ;
+
+		m_stamp = this->stamp() ;
+
+		return r ;
 	}
+	bool needsCompaction( size_t entries ) const
+	{
+		return m_journalLines > qMax( entries,static_cast< size_t >( 64 ) ) ;
+	}
+	/*
+	 * Replace the store file with "e" and empty the journal.
+	 */
+	bool save( const std::map< QString,favorites::entry >& e )
+	{
+		QSaveFile file( m_storePath ) ;
 
-	return e ;
-}
+		if( !file.open( QIODevice::WriteOnly ) ){
 
-utility2::result< favorites::entry > favorites::readFavorite( const QString& e,const QString& s ) const
+			return false ;
+		}
+
+		try{
+			for( const auto& it : e ){
+
+				SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+
+				_write_entry( json,it.second ) ;
+
+				file.write( json.structure( -1 ) + "\n" ) ;
+			}
+
+		}catch( const std::exception& e ){
+
+			_log_error( e.what(),m_storePath ) ;
+
+			file.cancelWriting() ;
+
+			return false ;
+		}
+
+		if( !file.commit() ){
+
+			return false ;
+		}
+
+		QFile( m_journalPath ).remove() ;
+
+		m_journalLines = 0 ;
+
+		m_stamp = this->stamp() ;
+
+		return true ;
+	}
+	/*
+	 * true if the files changed after we last read or wrote them.
+	 */
+	bool changedOnDisk() const
+	{
+		return m_stamp != this->stamp() ;
+	}
+	void removeFiles()
+	{
+		QFile( m_journalPath ).remove() ;
+		QFile( m_storePath ).remove() ;
+	}
+private:
+	QString stamp() const
+	{
+		auto _stamp = []( const QString& e ){
+
+			QFileInfo s( e ) ;
+
+			if( s.exists() ){
+
+				return QString::number( s.size() ) + ":" + QString::number( s.lastModified().toMSecsSinceEpoch() ) ;
+			}else{
+				return QString() ;
+			}
+		} ;
+
+		return _stamp( m_storePath ) + "/" + _stamp( m_journalPath ) ;
+	}
+	template< typename Function >
+	void read( const QString& path,Function function )
+	{
+		QFile file( path ) ;
+
+		if( !file.open( QIODevice::ReadOnly ) || file.size() == 0 ){
+
+			return ;
+		}
+
+		auto data = file.map( 0,file.size() ) ;
+
+		if( !data ){
+
+			return ;
+		}
+
+		auto it  = reinterpret_cast< const char * >( data ) ;
+		auto end = it + file.size() ;
+
+		while( it < end ){
+
+			auto m = static_cast< const char * >( std::memchr( it,'\n',static_cast< size_t >( end - it ) ) ) ;
+
+			if( m == nullptr ){
+
+				/*
+				 * A line cut short by a crash while it was being appended.
+				 */
+				break ;
+			}
+
+			/*
+			 * A line not ending a JSON object was cut short by a crash and later
+			 * ended by a newer line,it holds nothing we can use.
+			 */
+			if( m > it && *( m - 1 ) == '}' ){
+
+				try{
+					QByteArray line( it,static_cast< int >( m - it ) ) ;
+
+					SirikaliJson json( line,
+							   SirikaliJson::type::CONTENTS,
+							   []( const QString& e ){ utility::debug() << e ; } ) ;
+
+					function( json ) ;
+
+				}catch( const std::exception& e ){
+
+					_log_error( e.what(),path ) ;
+				}
+			}
+
+			it = m + 1 ;
+		}
+
+		file.unmap( data ) ;
+	}
+
+	QString m_storePath ;
+	QString m_journalPath ;
+	QString m_stamp ;
+	size_t m_journalLines = 0 ;
+} ;
+
+/*
+ * All favorites,read once from the favorites folder and indexed by file name and by
+ * the path components of their volume paths.
+ *
+ * On Linux,the folder is watched with inotify and pending events are collected before
+ * every lookup,a file that is written,renamed or removed behind our back is read again
+ * or forgotten.Changes we make ourselves are written through with update() and remove().
+ * Elsewhere,the folder is read again on every lookup.
+ *
+ * With the single file store in use,favorites are read from it instead and they are
+ * read again only when its files change behind our back.
+ */
+class favoritesIndex
 {
-	if( s.isEmpty() ){
+public:
+	favoritesIndex() : m_useStore( settings::instance().favoritesSingleFileStore() )
+	{
+#ifdef Q_OS_LINUX
+		if( !m_useStore ){
+
+			m_inotify_fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC ) ;
+		}
+#endif
+	}
+	bool usesStore() const
+	{
+		return m_useStore ;
+	}
+	favorites::error addToStore( const std::vector< favorites::entry >& e )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->refresh() ;
+
+		std::vector< favorites::entry > s ;
+
+		auto r = favorites::error::SUCCESS ;
+
+		for( const auto& it : e ){
 
-		for( const auto& it : favorites::readFavorites() ){
+			auto name = _create_path( QString(),it ) ;
 
-			if( it.volumePath == e ){
+			if( m_files.find( name ) != m_files.end() ){
 
-				return it ;
+				r = favorites::error::ENTRY_ALREADY_EXISTS ;
+			}else{
+				this->insert( name,it ) ;
+
+				s.emplace_back( it ) ;
 			}
 		}
-	}else{
-		for( const auto& it : favorites::readFavorites() ){
 
-			if( it.volumePath == e && it.mountPointPath == s ){
+		if( !s.empty() && !m_store.append( s,true ) ){
+
+			r = favorites::error::FAILED_TO_CREATE_ENTRY ;
+		}
 
-				return it ;
+		this->compact() ;
+
+		return r ;
+	}
+	void removeFromStore( const favorites::entry& e )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->refresh() ;
+
+		auto name = _create_path( QString(),e ) ;
+
+		if( m_files.find( name ) != m_files.end() ){
+
+			this->erase( name ) ;
+
+			m_store.append( { e },false ) ;
+
+			this->compact() ;
+		}
+	}
+	/*
+	 * Move favorites to the layout in use if they are in the other one.
+	 */
+	void migrate()
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		if( m_useStore ){
+
+			if( m_store.exists() ){
+
+				return ;
+			}
+
+			const auto m = _config_path() ;
+
+			if( !m.has_value() ){
+
+				return ;
+			}
+
+			const auto& a = m.value() ;
+
+			std::map< QString,favorites::entry > e ;
+			QStringList files ;
+
+			for( const auto& it : QDir( a ).entryList( QDir::Filter::Files | QDir::Filter::Hidden ) ){
+
+				auto s = _read_favorite( a + it ) ;
+
+				if( s ){
+
+					e[ _create_path( QString(),s.value() ) ] = s.value() ;
+
+					files.append( a + it ) ;
+				}
+			}
+
+			if( m_store.save( e ) ){
+
+				for( const auto& it : files ){
+
+					QFile( it ).remove() ;
+				}
+
+				utility::debug() << QString( "Moved %1 favorites to the single file store" ).arg( e.size() ) ;
+			}
+		}else{
+			if( !m_store.exists() ){
+
+				return ;
+			}
+
+			const auto e = m_store.load() ;
+
+			bool moved = true ;
+
+			for( const auto& it : e ){
+
+				auto s = _add_file( it.second ) ;
+
+				if( s == favorites::error::FAILED_TO_CREATE_ENTRY ){
+
+					moved = false ;
+				}
+			}
+
+			if( moved ){
+
+				m_store.removeFiles() ;
+
+				utility::debug() << QString( "Moved %1 favorites out of the single file store" ).arg( e.size() ) ;
 			}
 		}
+
+		m_loaded = false ;
 	}
+	std::vector< favorites::entry > entries()
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
 
-	return {} ;
+		this->refresh() ;
+
+		std::vector< favorites::entry > s ;
+
+		s.reserve( m_files.size() ) ;
+
+		for( const auto& it : m_files ){
+
+			s.emplace_back( it.second ) ;
+		}
+
+		return s ;
+	}
+	utility2::result< favorites::entry > find( const QString& volumePath,const QString& mountPointPath )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->refresh() ;
+
+		auto it = m_volumes.find( volumePath ) ;
+
+		if( it ){
+
+			for( const auto& name : *it ){
+
+				const auto& m = m_files[ name ] ;
+
+				if( m.volumePath != volumePath ){
+
+					/*
+					 * Same path components,different spelling.
+					 */
+					continue ;
+				}
+
+				if( mountPointPath.isEmpty() || m.mountPointPath == mountPointPath ){
+
+					return m ;
+				}
+			}
+		}
+
+		return {} ;
+	}
+	std::vector< favorites::entry > under( const QString& path )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->refresh() ;
+
+		std::vector< favorites::entry > s ;
+
+		m_volumes.forEachUnder( path,[ & ]( const QString& name ){
+
+			s.emplace_back( m_files[ name ] ) ;
+		} ) ;
+
+		return s ;
+	}
+	void update( const QString& path,const favorites::entry& e )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		if( m_loaded ){
+
+			this->insert( QFileInfo( path ).fileName(),e ) ;
+		}
+	}
+	void remove( const QString& path )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		if( m_loaded ){
+
+			this->erase( QFileInfo( path ).fileName() ) ;
+		}
+	}
+private:
+	void refresh()
+	{
+		if( m_useStore ){
+
+			if( !m_loaded || m_store.changedOnDisk() ){
+
+				this->load() ;
+			}
+
+			return ;
+		}
+#ifdef Q_OS_LINUX
+		if( m_loaded && m_inotify_fd != -1 ){
+
+			this->processEvents() ;
+		}else{
+			this->load() ;
+		}
+#else
+		this->load() ;
+#endif
+	}
+	void load()
+	{
+		m_files.clear() ;
+		m_volumes.clear() ;
+
+		m_loaded = false ;
+
+		if( m_useStore ){
+
+			for( auto& it : m_store.load() ){
+
+				this->insert( it.first,it.second ) ;
+			}
+
+			m_loaded = true ;
+
+			return ;
+		}
+
+		const auto m = _config_path() ;
+
+		if( !m.has_value() ){
+
+			return ;
+		}
+
+		m_path = m.value() ;
+#ifdef Q_OS_LINUX
+		if( m_inotify_fd != -1 ){
+
+			/*
+			 * New files are picked up when they are closed after writing,not when
+			 * they are created and still empty.
+			 */
+			auto mask = IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM |
+				    IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR ;
+
+			inotify_add_watch( m_inotify_fd,m_path.toLocal8Bit().constData(),mask ) ;
+		}
+#endif
+		const auto s = QDir( m_path ).entryList( QDir::Filter::Files | QDir::Filter::Hidden ) ;
+
+		for( const auto& it : s ){
+
+			this->read( it ) ;
+		}
+
+		m_loaded = true ;
+	}
+#ifdef Q_OS_LINUX
+	void processEvents()
+	{
+		char buffer[ 16 * ( sizeof( struct inotify_event ) + NAME_MAX + 1 ) ] ;
+
+		bool reload = false ;
+
+		while( true ){
+
+			auto s = ::read( m_inotify_fd,buffer,sizeof( buffer ) ) ;
+
+			if( s <= 0 ){
+
+				break ;
+			}
+
+			const char * it  = buffer ;
+			const char * end = buffer + s ;
+
+			while( it < end ){
+
+				auto e = reinterpret_cast< const struct inotify_event * >( it ) ;
+
+				if( e->mask & ( IN_Q_OVERFLOW | IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED ) ){
+
+					reload = true ;
+
+				}else if( e->len > 0 && !reload ){
+
+					auto name = QString::fromLocal8Bit( e->name ) ;
+
+					if( e->mask & ( IN_DELETE | IN_MOVED_FROM ) ){
+
+						this->erase( name ) ;
+					}else{
+						this->read( name ) ;
+					}
+				}
+
+				it += sizeof( struct inotify_event ) + e->len ;
+			}
+		}
+
+		if( reload ){
+
+			this->load() ;
+		}
+	}
+#endif
+	void read( const QString& name )
+	{
+		auto m = _read_favorite( m_path + name ) ;
+
+		if( m ){
+
+			this->insert( name,m.value() ) ;
+		}else{
+			this->erase( name ) ;
+		}
+	}
+	void insert( const QString& name,const favorites::entry& e )
+	{
+		this->erase( name ) ;
+
+		m_files[ name ] = e ;
+		m_volumes.insert( e.volumePath,name ) ;
+	}
+	void compact()
+	{
+		if( m_store.needsCompaction( m_files.size() ) ){
+
+			m_store.save( m_files ) ;
+		}
+	}
+	void erase( const QString& name )
+	{
+		auto it = m_files.find( name ) ;
+
+		if( it == m_files.end() ){
+
+			return ;
+		}
+
+		m_volumes.remove( it->second.volumePath,name ) ;
+
+		m_files.erase( it ) ;
+	}
+
+	std::mutex m_mutex ;
+	bool m_useStore ;
+	bool m_loaded = false ;
+	int m_inotify_fd = -1 ;
+	favoritesStore m_store ;
+	QString m_path ;
+	std::map< QString,favorites::entry > m_files ;
+	pathTrie< QString > m_volumes ;
+} ;
+
+static favoritesIndex& _favorites_index()
+{
+	static favoritesIndex m ;
+
+	return m ;
+}
+
+utility2::result< favorites::entry > favorites::readFavoriteByPath( const QString& path ) const
+{
+	return _read_favorite( path ) ;
+}
+
+std::vector<favorites::entry> favorites::readFavorites() const
+{
+	return _favorites_index().entries() ;
+}
+
+std::vector< favorites::entry > favorites::readFavoritesUnder( const QString& e ) const
+{
+	return _favorites_index().under( e ) ;
+}
+
+utility2::result< favorites::entry > favorites::readFavorite( const QString& e,const QString& s ) const
+{
+	return _favorites_index().find( e,s ) ;
 }
 
 void favorites::updateFavorites()
 {
+	_favorites_index().migrate() ;
+
 	auto& m = settings::instance().backend() ;
 
 	if( m.contains( "FavoritesVolumes" ) ){
@@ -232,65 +959,58 @@ void favorites::updateFavorites()
 
 		m.remove( "FavoritesVolumes" ) ;
 
+		std::vector< favorites::entry > e ;
+
 		for( const auto& it : a ){
 
-			_move_favorites_to_new_system( utility::split( it,'\t' ) ) ;
+			e.emplace_back( _move_favorites_to_new_system( utility::split( it,'\t' ) ) ) ;
 		}
+
+		favorites::instance().add( e ) ;
 	}
 }
 
 favorites::error favorites::add( const favorites::entry& e )
 {
-	auto m = _config_path() ;
+	auto& index = _favorites_index() ;
 
-	if( !m.has_value() ){
+	if( index.usesStore() ){
 
-		return error::FAILED_TO_CREATE_ENTRY ;
+		return index.addToStore( { e } ) ;
 	}
 
-	auto a = _create_path( m.value(),e ) ;
+	auto s = _add_file( e ) ;
 
-	try{
-		SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+	if( s == error::SUCCESS ){
 
-		json[ "volumePath" ]           = e.volumePath ;
-		json[ "mountPointPath" ]       = e.mountPointPath ;
-		json[ "configFilePath" ]       = e.configFilePath ;
-		json[ "keyFilePath" ]          = e.keyFile ;
-		json[ "idleTimeOut" ]          = e.idleTimeOut ;
-		json[ "mountOptions" ]         = e.mountOptions ;
-		json[ "preMountCommand" ]      = e.preMountCommand ;
-		json[ "postMountCommand" ]     = e.postMountCommand ;
-		json[ "preUnmountCommand" ]    = e.preUnmountCommand ;
-		json[ "postUnmountCommand" ]   = e.postUnmountCommand ;
-		json[ "reverseMode" ]          = e.reverseMode ;
-		json[ "volumeNeedNoPassword" ] = e.volumeNeedNoPassword ;
-
-		favorites::triState::writeTriState( json,e.readOnlyMode,"mountReadOnly" ) ;
-		favorites::triState::writeTriState( json,e.autoMount,"autoMountVolume" ) ;
+		index.update( _create_path( e ),e ) ;
+	}
 
-		if( utility::pathExists( a ) ){
+	return s ;
+}
 
-			return error::ENTRY_ALREADY_EXISTS ;
-		}else{
-			if( json.toFile( a ) ){
+favorites::error favorites::add( const std::vector< favorites::entry >& e )
+{
+	auto& index = _favorites_index() ;
 
-				return error::SUCCESS ;
-			}else{
-				return error::FAILED_TO_CREATE_ENTRY ;
-			}
-		}
+	if( index.usesStore() ){
 
-	}catch( const std::exception& e ){
+		return index.addToStore( e ) ;
+	}
 
-		_log_error( e.what(),a ) ;
+	auto s = error::SUCCESS ;
 
-	}catch( ... ){
+	for( const auto& it : e ){
 
-		_log_error( "Unknown error has occured",a ) ;
+		auto m = favorites::add( it ) ;
+
+		if( m != error::SUCCESS ){
+
+			s = m ;
+		}
 	}
 
-	return error::FAILED_TO_CREATE_ENTRY ;
+	return s ;
 }
 
 void favorites::replaceFavorite( const favorites::entry& old,const favorites::entry& New )
@@ -301,11 +1021,20 @@ void favorites::replaceFavorite( const favorites::entry& old,const favorites::en
 
 void favorites::removeFavoriteEntry( const favorites::entry& e )
 {
+	auto& index = _favorites_index() ;
+
+	if( index.usesStore() ){
+
+		return index.removeFromStore( e ) ;
+	}
+
 	auto s = _create_path( e ) ;
 
 	if( !s.isEmpty() ){
 
 		QFile( s ).remove() ;
+
+		_favorites_index().remove( s ) ;
 	}
 }
 
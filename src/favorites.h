@@ -140,11 +140,22 @@ public:
 
 	error add( const favorites::entry& ) ;
 
+	/*
+	 * Adds many favorites,with one write when the single file store is in use.
+	 */
+	error add( const std::vector< favorites::entry >& ) ;
+
 	void replaceFavorite( const favorites::entry&, const favorites::entry& ) ;
 	void removeFavoriteEntry( const favorites::entry& ) ;
 
 	std::vector< favorites::entry > readFavorites() const ;
 
+	/*
+	 * Favorites whose volume paths are at or under the given path,"/a/b" is under "/a"
+	 * but "/ab" is not.
+	 */
+	std::vector< favorites::entry > readFavoritesUnder( const QString& ) const ;
+
 	utility2::result< favorites::entry > readFavorite( const QString&,const QString& = QString() ) const ;
 
 	utility2::result< favorites::entry > readFavoriteByPath( const QString& ) const ;
@@ -0,0 +1,216 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "favoritesmenu.h"
+#include "favorites.h"
+#include "settings.h"
+
+void favoritesMenu::update( QMenu * menu,const volumeRegistry& r,const QList< QAction * >& trailingActions )
+{
+	const auto favorites = favorites::instance().readFavorites() ;
+
+	auto& s = settings::instance() ;
+
+	auto showCipherPathAndMountPath = s.showCipherFolderAndMountPathInFavoritesList( favorites ) ;
+
+	QStringList keys ;
+
+	keys.reserve( static_cast< int >( favorites.size() ) ) ;
+
+	for( const auto& it : favorites ){
+
+		if( showCipherPathAndMountPath ){
+
+			keys.append( it.volumePath + "\n" + it.mountPointPath ) ;
+		}else{
+			keys.append( it.volumePath ) ;
+		}
+	}
+
+	if( menu != m_menu || keys != m_keys || showCipherPathAndMountPath != m_showCipherPathAndMountPath ){
+
+		m_menu = menu ;
+		m_keys = std::move( keys ) ;
+		m_showCipherPathAndMountPath = showCipherPathAndMountPath ;
+
+		this->rebuild( menu,trailingActions ) ;
+	}
+
+	/*
+	 * A mounted volume can only be claimed by one favorite,whatever is left unclaimed
+	 * gets its own entry.
+	 */
+	std::vector< bool > claimed( static_cast< size_t >( r.size() ),false ) ;
+
+	for( size_t i = 0 ; i < favorites.size() ; i++ ){
+
+		const auto& e = favorites[ i ] ;
+
+		int row = -1 ;
+
+		if( m_showCipherPathAndMountPath ){
+
+			auto m = r.row( e.mountPointPath ) ;
+
+			if( m != -1 && r.at( m ).volumePath == e.volumePath ){
+
+				row = m ;
+			}
+		}else{
+			for( auto m : r.rows( e.volumePath ) ){
+
+				if( !claimed[ static_cast< size_t >( m ) ] ){
+
+					row = m ;
+					break ;
+				}
+			}
+		}
+
+		if( row != -1 ){
+
+			claimed[ static_cast< size_t >( row ) ] = true ;
+		}
+
+		this->setMounted( m_favorites[ i ],r,row ) ;
+	}
+
+	QHash< QString,QAction * > mounted ;
+
+	for( int row = 0 ; row < r.size() ; row++ ){
+
+		if( claimed[ static_cast< size_t >( row ) ] ){
+
+			continue ;
+		}
+
+		const auto& e = r.at( row ) ;
+
+		auto n = this->text( e ) ;
+
+		auto it = m_mounted.find( e.mountPoint ) ;
+
+		QAction * ac ;
+
+		if( it != m_mounted.end() && it.value()->objectName() == n ){
+
+			ac = it.value() ;
+
+			m_mounted.erase( it ) ;
+		}else{
+			ac = new QAction( menu ) ;
+
+			ac->setText( n ) ;
+			ac->setObjectName( n ) ;
+			ac->setCheckable( true ) ;
+
+			menu->insertAction( m_end,ac ) ;
+		}
+
+		this->setMounted( ac,r,row ) ;
+
+		mounted.insert( e.mountPoint,ac ) ;
+	}
+
+	for( auto it = m_mounted.begin() ; it != m_mounted.end() ; it++ ){
+
+		/*
+		 * The action may be the one whose click got us here.
+		 */
+		menu->removeAction( it.value() ) ;
+		it.value()->deleteLater() ;
+	}
+
+	m_mounted = std::move( mounted ) ;
+}
+
+void favoritesMenu::retranslate()
+{
+	if( m_manageFavorites ){
+
+		m_manageFavorites->setText( QObject::tr( "Manage Favorites" ) ) ;
+		m_mountAll->setText( QObject::tr( "Mount All" ) ) ;
+	}
+}
+
+void favoritesMenu::rebuild( QMenu * menu,const QList< QAction * >& trailingActions )
+{
+	menu->clear() ;
+
+	m_favorites.clear() ;
+	m_mounted.clear() ;
+
+	m_manageFavorites = menu->addAction( QString() ) ;
+	m_manageFavorites->setObjectName( "Manage Favorites" ) ;
+
+	m_mountAll = menu->addAction( QString() ) ;
+	m_mountAll->setObjectName( "Mount All" ) ;
+
+	this->retranslate() ;
+
+	menu->addSeparator() ;
+
+	m_favorites.reserve( static_cast< size_t >( m_keys.size() ) ) ;
+
+	for( const auto& it : m_keys ){
+
+		auto ac = menu->addAction( it ) ;
+
+		ac->setObjectName( it ) ;
+		ac->setCheckable( true ) ;
+
+		m_favorites.emplace_back( ac ) ;
+
+		if( m_showCipherPathAndMountPath ){
+
+			menu->addSeparator() ;
+		}
+	}
+
+	m_end = menu->addSeparator() ;
+
+	menu->addActions( trailingActions ) ;
+}
+
+void favoritesMenu::setMounted( QAction * ac,const volumeRegistry& r,int row )
+{
+	auto mounted = row != -1 ;
+
+	if( ac->isChecked() != mounted ){
+
+		ac->setChecked( mounted ) ;
+	}
+
+	if( mounted ){
+
+		ac->setData( r.at( row ).mountPoint ) ;
+	}else{
+		ac->setData( QVariant() ) ;
+	}
+}
+
+QString favoritesMenu::text( const volumeRegistry::entry& e ) const
+{
+	if( m_showCipherPathAndMountPath ){
+
+		return e.volumePath + "\n" + e.mountPoint ;
+	}else{
+		return e.volumePath ;
+	}
+}
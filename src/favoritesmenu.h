@@ -0,0 +1,64 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FAVORITES_MENU_H
+#define FAVORITES_MENU_H
+
+#include <QMenu>
+#include <QAction>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+
+#include <vector>
+
+#include "volumeregistry.h"
+
+/*
+ * Keeps the favorites part of the tray icon context menu in sync with the favorites
+ * list and with what is currently mounted.
+ *
+ * The menu is only rebuilt when the favorites list itself changes.Otherwise,an update
+ * only checks or unchecks the favorites whose mounted state changed and adds or removes
+ * the entries of mounted volumes that are not favorites.
+ *
+ * Every checked action carries the mount point of its volume in its data().
+ */
+class favoritesMenu
+{
+public:
+	void update( QMenu *,const volumeRegistry&,const QList< QAction * >& trailingActions ) ;
+	void retranslate() ;
+private:
+	void rebuild( QMenu *,const QList< QAction * >& ) ;
+	void setMounted( QAction *,const volumeRegistry&,int row ) ;
+	QString text( const volumeRegistry::entry& ) const ;
+
+	QMenu * m_menu = nullptr ;
+	QAction * m_manageFavorites = nullptr ;
+	QAction * m_mountAll = nullptr ;
+	QAction * m_end = nullptr ;
+	QStringList m_keys ;
+	std::vector< QAction * > m_favorites ;
+	QHash< QString,QAction * > m_mounted ;
+	bool m_showCipherPathAndMountPath = false ;
+} ;
+
+#endif
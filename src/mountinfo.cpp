@@ -30,9 +30,13 @@
 #include <QtGlobal>
 
 #include <QFile>
+#include <QElapsedTimer>
 
 #include <vector>
 #include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 
 QString mountinfo::mountProperties( const QString& mountPoint,
 				    const QString& mode,
@@ -155,14 +159,52 @@ static QStringList _unlocked_volumes()
 		}
 	}() ;
 
-	return a + engines::instance().mountInfo( a ) ;
+	return a + engines::instance().mountInfo() ;
+}
+
+/*
+ * Same content as above but kept as raw bytes to let mountTable::parse() walk it
+ * without first splitting it into a list of strings.
+ */
+static QByteArray _unlocked_volumes_raw()
+{
+	auto _join = []( QByteArray& s,const QStringList& e ){
+
+		for( const auto& it : e ){
+
+			s += it.toUtf8() ;
+			s += '\n' ;
+		}
+	} ;
+
+	QByteArray s ;
+
+	if( utility::platformIsLinux() ){
+
+		s = utility::fileContents( "/proc/self/mountinfo" ) ;
+
+		if( !s.isEmpty() && !s.endsWith( '\n' ) ){
+
+			s += '\n' ;
+		}
+
+	}else if( utility::platformIsOSX() ){
+
+		_join( s,_macox_volumes() ) ;
+	}else{
+		_join( s,_windows_volumes() ) ;
+	}
+
+	_join( s,engines::instance().mountInfo() ) ;
+
+	return s ;
 }
 
 mountinfo::mountinfo( QObject * parent,bool e,std::function< void() >&& quit ) :
 	m_parent( parent ),
 	m_quit( std::move( quit ) ),
 	m_announceEvents( e ),
-	m_oldMountList( _unlocked_volumes() ),
+	m_mountTable( _unlocked_volumes() ),
 	m_dbusMonitor( [ this ]( const QString& e ){ this->autoMount( e ) ; } ),
 	m_folderMountEvents( [ this ]( const QString& e ){ this->autoMount( e ) ; } )
 {
@@ -182,95 +224,332 @@ mountinfo::~mountinfo()
 {
 }
 
-Task::future< std::vector< volumeInfo > >& mountinfo::unlockedVolumes()
+static std::vector< volumeInfo > _read_unlocked_volumes()
 {
-	return Task::run( [](){
+	auto _decode = []( QString path,bool set_offset ){
 
-		auto _decode = []( QString path,bool set_offset ){
+		engines::engine::decodeSpecialCharacters( path ) ;
 
-			engines::engine::decodeSpecialCharacters( path ) ;
+		if( set_offset ){
 
-			if( set_offset ){
+			return path.mid( path.indexOf( '@' ) + 1 ) ;
+		}else{
+			return path ;
+		}
+	} ;
 
-				return path.mid( path.indexOf( '@' ) + 1 ) ;
-			}else{
-				return path ;
+	auto _starts_with = []( const engines::engine& e,const QString& s ){
+
+		for( const auto& it : e.names() ){
+
+			if( s.startsWith( it + "@" ) ){
+
+				return true ;
 			}
-		} ;
+		}
 
-		auto _starts_with = []( const engines::engine& e,const QString& s ){
+		return false ;
+	} ;
 
-			for( const auto& it : e.names() ){
+	auto _fs = []( QString e ){
 
-				if( s.startsWith( it + "@" ) ){
+		e.replace( "fuse.","" ) ;
 
-					return true ;
-				}
+		return e ;
+	} ;
+
+	const auto& engines = engines::instance() ;
+
+	/*
+	 * File systems we could own that do not follow the "fuse.xxx" naming,ecryptfs
+	 * and fscrypt for example.
+	 */
+	std::vector< QByteArray > nonFuseNames ;
+
+	for( const auto& it : engines.supportedEngines() ){
+
+		for( const auto& xt : it->fuseNames() ){
+
+			if( !xt.startsWith( "fuse." ) ){
+
+				nonFuseNames.emplace_back( xt.toUtf8() ) ;
 			}
+		}
+	}
 
-			return false ;
-		} ;
+	auto _candidate = [ & ]( const mountTable::field& fs ){
 
-		auto _fs = []( QString e ){
+		if( fs.startsWith( "fuse.",5 ) ){
 
-			e.replace( "fuse.","" ) ;
+			return true ;
+		}
 
-			return e ;
-		} ;
+		for( const auto& it : nonFuseNames ){
 
-		auto _ro = []( const QStringList& l ){
+			if( fs.equalsCaseInsensitive( it ) ){
 
-			return l.at( 5 ).mid( 0,2 ) ;
-		} ;
+				return true ;
+			}
+		}
 
-		std::vector< volumeInfo > e ;
+		return false ;
+	} ;
 
-		volumeInfo::mountinfo info ;
+	std::vector< volumeInfo > e ;
 
-		const auto& engines = engines::instance() ;
+	volumeInfo::mountinfo info ;
 
-		for( const auto& it : _unlocked_volumes() ){
+	const auto data = _unlocked_volumes_raw() ;
+
+	mountTable::parse( data,[ & ]( const mountTable::fields& k ){
+
+		/*
+		 * Most entries belong to file systems we do not manage,reject them
+		 * before anything is allocated or decoded.
+		 */
+		if( !_candidate( k.fileSystem ) ){
 
-			const auto k = utility::split( it,' ' ) ;
+			return ;
+		}
 
-			const auto s = k.size() ;
+		const auto fs = k.fileSystem.toString() ;
 
-			if( s < 8 ){
+		const auto& engine = engines.getByFuseName( fs ) ;
 
-				continue ;
+		if( engine.known() ){
+
+			const auto cf = k.device.toString() ;
+
+			const auto m = k.mountPoint.toString() ;
+
+			if( _starts_with( engine,cf ) ){
+
+				info.volumePath = _decode( cf,true ) ;
+
+			}else if( engine.setsCipherPath() ){
+
+				info.volumePath = _decode( cf,false ) ;
+			}else{
+				info.volumePath = crypto::sha256( m ).mid( 0,20 ) ;
 			}
 
-			const auto& cf = k.at( s - 2 ) ;
+			info.mountPoint   = _decode( m,false ) ;
+			info.fileSystem   = _fs( fs ) ;
+			info.mode         = k.mountOptions.toString().mid( 0,2 ) ;
+			info.mountOptions = k.superOptions.toString() ;
 
-			const auto& m = k.at( 4 ) ;
+			e.emplace_back( info ) ;
+		}
+	} ) ;
 
-			const auto& fs = k.at( s - 3 ) ;
+	return e ;
+}
 
-			const auto& engine = engines.getByFuseName( fs ) ;
+/*
+ * A process wide snapshot of unlocked volumes.
+ *
+ * The snapshot is stamped with the generation it was built in and it is reused until
+ * the generation moves,the generation moves every time the mount monitor sees a change
+ * or we mount or unmount something ourselves.The snapshot is only trusted while the
+ * mount monitor is running since nothing else can tell us when it goes stale.
+ */
+static struct{
+
+	std::mutex mutex ;
+	std::condition_variable cv ;
+	std::vector< volumeInfo > volumes ;
+	quint64 generation = 0 ;
+	quint64 snapshotGeneration = 0 ;
+	bool hasSnapshot = false ;
+	bool rebuilding = false ;
+	bool monitoring = false ;
+	quint64 hits = 0 ;
+	quint64 misses = 0 ;
+	qint64 rebuildTime = 0 ;
+} _snapshot ;
+
+static std::vector< volumeInfo > _unlocked_volumes_snapshot()
+{
+	std::unique_lock< std::mutex > lock( _snapshot.mutex ) ;
+
+	while( true ){
 
-			if( engine.known() ){
+		if( _snapshot.monitoring &&
+		    _snapshot.hasSnapshot &&
+		    _snapshot.snapshotGeneration == _snapshot.generation ){
 
-				if( _starts_with( engine,cf ) ){
+			_snapshot.hits++ ;
 
-					info.volumePath = _decode( cf,true ) ;
+			return _snapshot.volumes ;
+		}
 
-				}else if( engine.setsCipherPath() ){
+		if( !_snapshot.rebuilding ){
 
-					info.volumePath = _decode( cf,false ) ;
-				}else{
-					info.volumePath = crypto::sha256( m ).mid( 0,20 ) ;
-				}
+			break ;
+		}
+
+		/*
+		 * Somebody else is already reading the mount table,wait for them.
+		 */
+		_snapshot.cv.wait( lock ) ;
+	}
+
+	_snapshot.misses++ ;
+	_snapshot.rebuilding = true ;
+
+	auto generation = _snapshot.generation ;
 
-				info.mountPoint   = _decode( m,false ) ;
-				info.fileSystem   = _fs( fs ) ;
-				info.mode         = _ro( k ) ;
-				info.mountOptions = k.last() ;
+	lock.unlock() ;
+
+	QElapsedTimer timer ;
+
+	timer.start() ;
+
+	auto volumes = _read_unlocked_volumes() ;
+
+	auto elapsed = timer.elapsed() ;
+
+	lock.lock() ;
+
+	_snapshot.volumes            = volumes ;
+	_snapshot.snapshotGeneration = generation ;
+	_snapshot.hasSnapshot        = true ;
+	_snapshot.rebuilding         = false ;
+	_snapshot.rebuildTime       += elapsed ;
+
+	auto a = QString::number( elapsed ) ;
+	auto b = QString::number( generation ) ;
+	auto c = QString::number( _snapshot.hits ) ;
+	auto d = QString::number( _snapshot.misses ) ;
+	auto e = QString::number( _snapshot.rebuildTime ) ;
+
+	lock.unlock() ;
+
+	_snapshot.cv.notify_all() ;
+
+	utility::debug() << QString( "Unlocked volumes snapshot rebuilt in %1 ms(generation %2,hits %3,misses %4,total rebuild time %5 ms)" ).arg( a,b,c,d,e ) ;
+
+	return volumes ;
+}
 
-				e.emplace_back( info ) ;
+static void _set_monitoring( bool e )
+{
+	std::lock_guard< std::mutex > lock( _snapshot.mutex ) ;
+
+	_snapshot.monitoring = e ;
+	_snapshot.generation++ ;
+}
+
+void mountinfo::volumesChanged()
+{
+	{
+		std::lock_guard< std::mutex > lock( _snapshot.mutex ) ;
+
+		_snapshot.generation++ ;
+	}
+
+	_snapshot.cv.notify_all() ;
+}
+
+quint64 mountinfo::generation()
+{
+	std::lock_guard< std::mutex > lock( _snapshot.mutex ) ;
+
+	return _snapshot.generation ;
+}
+
+bool mountinfo::waitForNextGeneration( quint64 generation,int milliseconds )
+{
+	std::unique_lock< std::mutex > lock( _snapshot.mutex ) ;
+
+	auto m = std::chrono::milliseconds( milliseconds ) ;
+
+	return _snapshot.cv.wait_for( lock,m,[ & ](){ return _snapshot.generation != generation ; } ) ;
+}
+
+/*
+ * Wait for at most "milliseconds" for "function" to accept the list of unlocked volumes.
+ */
+template< typename Function >
+static bool _wait_for_volumes( int milliseconds,Function&& function )
+{
+	QElapsedTimer timer ;
+
+	timer.start() ;
+
+	while( true ){
+
+		auto generation = mountinfo::generation() ;
+
+		if( function( _unlocked_volumes_snapshot() ) ){
+
+			return true ;
+		}
+
+		auto remaining = milliseconds - timer.elapsed() ;
+
+		if( remaining <= 0 ){
+
+			return false ;
+		}
+
+		auto monitoring = [](){
+
+			std::lock_guard< std::mutex > lock( _snapshot.mutex ) ;
+
+			return _snapshot.monitoring ;
+		}() ;
+
+		if( !monitoring ){
+
+			/*
+			 * Nothing moves the generation forward when the mount monitor is not
+			 * running,look again a little later.
+			 */
+			remaining = qMin( remaining,static_cast< qint64 >( 100 ) ) ;
+		}
+
+		mountinfo::waitForNextGeneration( generation,static_cast< int >( remaining ) ) ;
+	}
+}
+
+bool mountinfo::waitForVolume( const QString& cipherPath,const QString& mountPoint,int milliseconds )
+{
+	return _wait_for_volumes( milliseconds,[ & ]( const std::vector< volumeInfo >& e ){
+
+		for( const auto& it : e ){
+
+			if( it.volumePath() == cipherPath || it.mountPoint() == mountPoint ){
+
+				return true ;
 			}
 		}
 
-		return e ;
+		return false ;
+	} ) ;
+}
+
+bool mountinfo::waitForVolumeRemoval( const QString& mountPoint,int milliseconds )
+{
+	return _wait_for_volumes( milliseconds,[ & ]( const std::vector< volumeInfo >& e ){
+
+		for( const auto& it : e ){
+
+			if( it.mountPoint() == mountPoint ){
+
+				return false ;
+			}
+		}
+
+		return true ;
+	} ) ;
+}
+
+Task::future< std::vector< volumeInfo > >& mountinfo::unlockedVolumes()
+{
+	return Task::run( [](){
+
+		return _unlocked_volumes_snapshot() ;
 	} ) ;
 }
 
@@ -286,49 +565,68 @@ void mountinfo::stop()
 
 void mountinfo::volumeUpdate()
 {
-	m_newMountList = _unlocked_volumes() ;
-
-	auto _volumeWasMounted = [ & ](){
+	auto events = m_pendingEvents.exchange( 0 ) ;
 
-		return m_oldMountList.size() < m_newMountList.size() ;
-	} ;
-
-	auto _mountedVolume = [ & ]( const QString& e ){
+	if( events == 0 ){
 
-		return !m_oldMountList.contains( e ) ;
-	} ;
+		/*
+		 * An earlier refresh already picked up the events this one was queued for.
+		 */
+		return ;
+	}
 
-	if( m_announceEvents ){
+	m_totalEvents += events ;
+	m_totalRefreshes++ ;
 
-		this->pbUpdate() ;
+	mountTable s( _unlocked_volumes() ) ;
 
-		if( _volumeWasMounted() ){
+	auto delta = m_mountTable.diff( s ) ;
 
-			for( const auto& it : m_newMountList ){
+	m_mountTable = std::move( s ) ;
 
-				const auto e = utility::split( it,' ' ) ;
+	if( m_announceEvents && delta.isNotEmpty() ){
 
-				if( _mountedVolume( it ) && e.size() > 4 ){
+		this->pbUpdate( delta,events ) ;
 
-					this->autoMount( e.at( 4 ) ) ;
-				}
-			}
-		}
+		this->autoMount( delta ) ;
 	}
-
-	m_oldMountList = std::move( m_newMountList ) ;
 }
 
-void mountinfo::updateVolume()
+void mountinfo::updateVolume( int events )
 {
+	m_pendingEvents += events ;
+
 	QMetaObject::invokeMethod( this,"volumeUpdate",Qt::QueuedConnection ) ;
 }
 
-void mountinfo::pbUpdate()
+void mountinfo::pbUpdate( const mountTable::delta& e,int events )
 {
+	auto a = QString::number( e.added.size() ) ;
+	auto b = QString::number( e.removed.size() ) ;
+	auto c = QString::number( e.changed.size() ) ;
+
+	utility::debug() << QString( "Mount table changed: %1 added,%2 removed,%3 changed" ).arg( a,b,c ) ;
+
+	auto d = QString::number( events ) ;
+	auto f = QString::number( m_totalEvents ) ;
+	auto g = QString::number( m_totalRefreshes ) ;
+
+	utility::debug() << QString( "Mount events: %1 folded into this refresh,%2 events in %3 refreshes so far" ).arg( d,f,g ) ;
+
 	QMetaObject::invokeMethod( m_parent,"pbUpdate",Qt::QueuedConnection ) ;
 }
 
+void mountinfo::autoMount( const mountTable::delta& e )
+{
+	for( const auto& it : e.added ){
+
+		if( !it.mountPoint().isEmpty() ){
+
+			this->autoMount( it.mountPoint() ) ;
+		}
+	}
+}
+
 void mountinfo::autoMount( const QString& e )
 {
 	QMetaObject::invokeMethod( m_parent,
@@ -344,45 +642,103 @@ void mountinfo::announceEvents( bool s )
 
 void mountinfo::linuxMonitor()
 {
-	auto s = std::addressof( Task::run( [ this ](){
+	auto quietWindow = settings::instance().mountEventsQuietWindow() ;
+	auto maxLatency  = settings::instance().mountEventsMaxLatency() ;
+
+	auto s = std::addressof( Task::run_io( [ this,quietWindow,maxLatency ](){
 
+		/*
+		 * Mount table changes,the burst timer and folder events are all served by
+		 * m_eventMonitor from this one thread.
+		 */
 		QFile s( "/proc/self/mountinfo" ) ;
-		struct pollfd m ;
 
-		s.open( QIODevice::ReadOnly ) ;
-		m.fd     = s.handle() ;
-		m.events = POLLPRI ;
+		auto opened = s.open( QIODevice::ReadOnly ) ;
 
-		while( true ){
+		auto mountInfoFd = opened ? s.handle() : -1 ;
+		auto timerFd     = eventMonitor::createTimer() ;
 
-			poll( &m,1,-1 ) ;
+		int events = 0 ;
 
-			this->updateVolume() ;
-		}
-	} ) ) ;
+		QElapsedTimer timer ;
+
+		auto _flush = [ & ](){
 
-	m_stop = [ s ](){ s->first_thread()->terminate() ; } ;
+			eventMonitor::disarmTimer( timerFd ) ;
 
-	if( m_folderMountEvents.monitor() ){
+			if( events > 0 ){
 
-		auto e = std::addressof( Task::run( [ & ](){
+				this->updateVolume( events ) ;
 
-			m_folderMountEvents.start() ;
-		} ) ) ;
+				events = 0 ;
+			}
+		} ;
 
-		e->then( [ & ](){
+		auto timerAdded = m_eventMonitor.add( timerFd,eventMonitor::readable,[ & ]( uint32_t ){
 
-			m_folderMountEvents.stop() ;
-			m_quit() ;
+			_flush() ;
 		} ) ;
 
-		s->then( [ = ](){
+		auto mountInfoAdded = m_eventMonitor.add( mountInfoFd,eventMonitor::priority,[ & ]( uint32_t ){
+
+			/*
+			 * Mounting or unmounting many volumes at once generates a burst of
+			 * events,keep folding them until the table has been quiet for
+			 * "quietWindow" milliseconds or until "maxLatency" milliseconds have
+			 * passed since the first one and then refresh once.
+			 */
+			mountinfo::volumesChanged() ;
+
+			m_folderMountEvents.mountTableChanged() ;
+
+			if( events == 0 ){
+
+				timer.start() ;
+			}
+
+			events++ ;
+
+			auto remaining = maxLatency - timer.elapsed() ;
 
-			e->first_thread()->terminate() ;
+			if( remaining <= 0 ){
+
+				_flush() ;
+			}else{
+				auto wait = qMin( remaining,static_cast< qint64 >( quietWindow ) ) ;
+
+				eventMonitor::armTimer( timerFd,static_cast< int >( wait ) ) ;
+			}
 		} ) ;
-	}else{
-		s->then( std::move( m_quit ) ) ;
-	}
+
+		if( m_folderMountEvents.monitor() ){
+
+			m_folderMountEvents.start( m_eventMonitor ) ;
+		}
+
+		/*
+		 * The snapshot can only be trusted if we will hear about every change to the
+		 * mount table,readers keep reading it themselves otherwise.
+		 */
+		_set_monitoring( opened && timerAdded && mountInfoAdded ) ;
+
+		m_eventMonitor.run() ;
+
+		_set_monitoring( false ) ;
+
+		m_folderMountEvents.stop( m_eventMonitor ) ;
+
+		m_eventMonitor.remove( mountInfoFd ) ;
+		m_eventMonitor.remove( timerFd ) ;
+
+		if( timerFd != -1 ){
+
+			close( timerFd ) ;
+		}
+	} ) ) ;
+
+	m_stop = [ this ](){ m_eventMonitor.stop() ; } ;
+
+	s->then( std::move( m_quit ) ) ;
 }
 
 void mountinfo::pollForUpdates()
@@ -393,7 +749,7 @@ void mountinfo::pollForUpdates()
 
 	auto interval = settings::instance().pollForUpdatesInterval() ;
 
-	Task::run( [ &,interval ](){
+	Task::run_io( [ &,interval ](){
 
 		auto previous = QStorageInfo::mountedVolumes() ;
 		auto now = previous ;
@@ -433,170 +789,249 @@ void mountinfo::windowsMonitor()
 #ifdef Q_OS_LINUX
 
 #include <sys/inotify.h>
-#include <sys/select.h>
+#include <limits.h>
+
+/*
+ * Large enough for 64 events with the longest possible names,the kernel never splits
+ * an event across reads.
+ */
+static const size_t _inotify_buffer_size = 64 * ( sizeof( struct inotify_event ) + NAME_MAX + 1 ) ;
+
+static const uint32_t _inotify_mask = IN_CREATE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR ;
 
 mountinfo::folderMountEvents::folderMountEvents( std::function< void( const QString& ) > function ) :
-	m_inotify_fd( inotify_init() ),m_update( std::move( function ) )
+	m_maxDepth( settings::instance().mountMonitorFolderDepth() ),
+	m_inotify_fd( inotify_init1( IN_NONBLOCK | IN_CLOEXEC ) ),
+	m_update( std::move( function ) )
 {
 	if( m_inotify_fd != -1 ){
 
 		for( const auto& it : settings::instance().mountMonitorFolderPaths() ){
 
-			int e = inotify_add_watch( m_inotify_fd,it.toLatin1(),IN_CREATE ) ;
+			auto s = it ;
 
-			if( e != -1 ){
+			while( s.endsWith( "/" ) ){
 
-				if( it.endsWith( "/" ) ){
-
-					auto s = it ;
-
-					while( s.endsWith( "/" ) ){
+				s = utility::removeLast( s,1 ) ;
+			}
 
-						s = utility::removeLast( s,1 ) ;
-					}
+			if( !s.isEmpty() ){
 
-					m_fds.emplace_back( e,s ) ;
-				}else{
-					m_fds.emplace_back( e,it ) ;
-				}
+				m_roots.emplace_back( s ) ;
 			}
 		}
+
+		this->rearm() ;
 	}
 }
 
-void mountinfo::folderMountEvents::start()
+void mountinfo::folderMountEvents::addWatch( const QString& path,int depth,int root )
 {
-	const char * currentEvent ;
-	const char * end ;
+	int wd = inotify_add_watch( m_inotify_fd,path.toLocal8Bit().constData(),_inotify_mask ) ;
 
-	std::vector< char > buffer( 10485760 ) ;
+	if( wd == -1 ){
 
-	fd_set rfds ;
+		return ;
+	}
 
-	FD_ZERO( &rfds ) ;
+	m_watches.insert( wd,{ path + "/",depth,root } ) ;
 
-	struct timeval tv ;
+	if( depth == 0 ){
 
-	int select_fd = m_inotify_fd + 1 ;
+		m_roots[ static_cast< size_t >( root ) ].armed = true ;
+	}
 
-	//int interval = settings::instance().mountMonitorFolderPollingInterval() ;
-	int interval = 0 ; //No longer listening for timeouts
+	if( depth < m_maxDepth ){
 
-	auto _reset_variables = [ & ](){
+		const auto m = QDir( path ).entryList( QDir::NoDotAndDotDot | QDir::Dirs | QDir::NoSymLinks ) ;
 
-		FD_SET( m_inotify_fd,&rfds ) ;
+		for( const auto& it : m ){
 
-		tv.tv_sec = interval ;
-		tv.tv_usec = 0 ;
-	} ;
+			this->addWatch( path + "/" + it,depth + 1,root ) ;
+		}
+	}
+}
 
-	struct event{
-		bool eventReceived ;
-		bool timeout ;
-	} ;
+void mountinfo::folderMountEvents::removeWatch( int wd,bool removeFromKernel )
+{
+	auto it = m_watches.find( wd ) ;
 
-	auto _eventsReceived = [ & ]()->event{
+	if( it == m_watches.end() ){
 
-		_reset_variables() ;
+		return ;
+	}
 
-		int r = [ & ](){
+	if( it.value().depth == 0 ){
 
-			if( tv.tv_sec > 0 ){
+		m_roots[ static_cast< size_t >( it.value().root ) ].armed = false ;
+	}
 
-				return select( select_fd,&rfds,nullptr,nullptr,&tv ) ;
-			}else{
-				return select( select_fd,&rfds,nullptr,nullptr,nullptr ) ;
-			}
-		}() ;
+	if( removeFromKernel ){
 
-		if( r == 0 ){
+		inotify_rm_watch( m_inotify_fd,wd ) ;
+	}
 
-			return { false,true } ;
+	m_watches.erase( it ) ;
+}
 
-		}else if( r > 0 ){
+void mountinfo::folderMountEvents::rearm()
+{
+	for( size_t i = 0 ; i < m_roots.size() ; i++ ){
 
-			auto s = read( m_inotify_fd,buffer.data(),buffer.size() ) ;
+		if( !m_roots[ i ].armed ){
 
-			if( s > 0 ){
+			this->addWatch( m_roots[ i ].path,0,static_cast< int >( i ) ) ;
+		}
+	}
+}
 
-				end          = buffer.data() + s ;
-				currentEvent = buffer.data() ;
+void mountinfo::folderMountEvents::rescan()
+{
+	/*
+	 * Events were lost,walk every root again.Adding a watch to a folder that already
+	 * has one gives back the same watch and folders created while events were being
+	 * dropped get theirs.Everything under each root is then reported since we can not
+	 * know what showed up in the meantime.
+	 */
+	for( size_t i = 0 ; i < m_roots.size() ; i++ ){
 
-				return { true,false } ;
-			}
+		this->addWatch( m_roots[ i ].path,0,static_cast< int >( i ) ) ;
+	}
+
+	for( const auto& it : m_roots ){
+
+		if( it.armed ){
+
+			m_update( it.path ) ;
 		}
+	}
+}
 
-		return { false,false } ;
-	} ;
+void mountinfo::folderMountEvents::mountTableChanged()
+{
+	/*
+	 * A root folder that was deleted or whose file system was unmounted may be
+	 * back now.
+	 */
+	if( m_inotify_fd != -1 ){
 
-	auto _processEvent = [ & ]( const struct inotify_event * event ){
+		this->rearm() ;
+	}
+}
 
-		if( event->mask & IN_CREATE ){
+void mountinfo::folderMountEvents::start( eventMonitor& e )
+{
+	m_buffer.resize( _inotify_buffer_size ) ;
 
-			for( auto& it : m_fds ){
+	e.add( m_inotify_fd,eventMonitor::readable,[ this ]( uint32_t ){
 
-				if( it.fd() == event->wd ){
+		this->processEvents() ;
+	} ) ;
+}
 
-					m_update( it.path() + event->name ) ;
+void mountinfo::folderMountEvents::processEvent( const struct inotify_event * event )
+{
+	if( event->mask & IN_Q_OVERFLOW ){
 
-					break ;
-				}
-			}
-		}
-	} ;
+		utility::debug() << "Folder monitor event queue overflowed,rescanning watched folders" ;
 
-	while( true ){
+		return this->rescan() ;
+	}
 
-		auto e = _eventsReceived() ;
+	auto it = m_watches.find( event->wd ) ;
 
-		if( e.eventReceived ){
+	if( it == m_watches.end() ){
 
-			while( currentEvent < end ){
+		return ;
+	}
 
-				auto event = reinterpret_cast< const struct inotify_event * >( currentEvent ) ;
+	if( event->mask & IN_IGNORED ){
 
-				_processEvent( event ) ;
-				currentEvent += sizeof( struct inotify_event ) + event->len ;
-			}
+		/*
+		 * The kernel already dropped this watch,the folder was deleted or its
+		 * file system was unmounted.
+		 */
+		this->removeWatch( event->wd,false ) ;
 
-		}else if( e.timeout ){
+	}else if( event->mask & ( IN_DELETE_SELF | IN_MOVE_SELF ) ){
 
-			/*
-			 * Not listening to timeouts
-			 */
+		this->removeWatch( event->wd,true ) ;
+
+	}else if( event->mask & ( IN_CREATE | IN_MOVED_TO ) ){
+
+		auto path = it.value().path + event->name ;
+		auto depth = it.value().depth ;
+		auto root = it.value().root ;
+
+		m_update( path ) ;
+
+		if( ( event->mask & IN_ISDIR ) && depth < m_maxDepth ){
+
+			this->addWatch( path,depth + 1,root ) ;
 		}
 	}
 }
 
-void mountinfo::folderMountEvents::stop()
+void mountinfo::folderMountEvents::processEvents()
 {
-	close( m_inotify_fd ) ;
+	while( true ){
+
+		auto s = read( m_inotify_fd,m_buffer.data(),m_buffer.size() ) ;
+
+		if( s <= 0 ){
+
+			break ;
+		}
+
+		const char * currentEvent = m_buffer.data() ;
+		const char * end          = m_buffer.data() + s ;
+
+		while( currentEvent < end ){
+
+			auto event = reinterpret_cast< const struct inotify_event * >( currentEvent ) ;
+
+			this->processEvent( event ) ;
+
+			currentEvent += sizeof( struct inotify_event ) + event->len ;
+		}
+	}
 }
 
-bool mountinfo::folderMountEvents::monitor()
+void mountinfo::folderMountEvents::stop( eventMonitor& e )
 {
-	return m_inotify_fd != -1 && m_fds.size() > 0 ;
+	if( m_inotify_fd != -1 ){
+
+		e.remove( m_inotify_fd ) ;
+
+		close( m_inotify_fd ) ;
+
+		m_inotify_fd = -1 ;
+	}
 }
 
-mountinfo::folderMountEvents::entry::~entry()
+bool mountinfo::folderMountEvents::monitor()
 {
-	close( m_fd ) ;
+	return m_inotify_fd != -1 && !m_roots.empty() ;
 }
 
 #else
 
-mountinfo::folderMountEvents::entry::~entry()
+mountinfo::folderMountEvents::folderMountEvents( std::function< void( const QString& ) > e )
 {
+	Q_UNUSED( e )
 }
-
-mountinfo::folderMountEvents::folderMountEvents( std::function< void( const QString& ) > e )
+void mountinfo::folderMountEvents::start( eventMonitor& e )
 {
 	Q_UNUSED( e )
 }
-void mountinfo::folderMountEvents::start()
+void mountinfo::folderMountEvents::processEvents()
 {
 }
-void mountinfo::folderMountEvents::stop()
+void mountinfo::folderMountEvents::stop( eventMonitor& e )
+{
+	Q_UNUSED( e )
+}
+void mountinfo::folderMountEvents::mountTableChanged()
 {
 }
 bool mountinfo::folderMountEvents::monitor()
@@ -631,128 +1066,181 @@ static QString _gvfs_fuse_path()
 
 dbusMonitor::dbusMonitor( folderMonitor::function function ) :
 	m_dbus( this ),
-	m_folderMonitor( true,_gvfs_fuse_path() ),
+	m_folderMonitor( _gvfs_fuse_path() ),
 	m_function( std::move( function ) )
 {
 	utility::debug() << "gvfs fuse path: " + m_folderMonitor.path() ;
 
 	if( !m_folderMonitor.path().isEmpty() ){
 
+		m_timer.setSingleShot( true ) ;
+		m_timer.setInterval( 6000 ) ;
+
+		connect( &m_timer,SIGNAL( timeout() ),this,SLOT( timedOut() ) ) ;
+
+		m_retryTimer.setSingleShot( true ) ;
+
+		connect( &m_retryTimer,SIGNAL( timeout() ),this,SLOT( retry() ) ) ;
+
+		connect( &m_watcher,SIGNAL( directoryChanged( QString ) ),this,SLOT( folderChanged() ) ) ;
+
+		m_watcher.addPath( m_folderMonitor.path() ) ;
+
 		m_dbus.monitor() ;
 	}
 }
 
 void dbusMonitor::volumeRemoved()
 {
-	static folderMonitor::function ss = []( const QString& e ){
-
-		utility::debug() << "gvfs fuse unmount: " + e ;
-	} ;
+	m_pendingSignals++ ;
 
-	m_folderMonitor.contentCountDecreased( ss ) ;
+	this->synchronize() ;
 }
 
 void dbusMonitor::volumeAdded()
 {
-	static folderMonitor::function ss = [ & ]( const QString& e ){
+	m_pendingSignals++ ;
 
-		utility::debug() << "gvfs fuse mount: " + e ;
+	this->synchronize() ;
+}
 
-		m_function( e ) ;
-	} ;
+void dbusMonitor::folderChanged()
+{
+	if( m_pendingSignals > 0 ){
 
-	m_folderMonitor.contentCountIncreased( ss ) ;
+		this->synchronize() ;
+	}
 }
 
-folderMonitor::folderMonitor( bool e,const QString& path ) :
-	m_path( path ),m_folderList( this->folderList() ),m_waitForSynced( e )
+void dbusMonitor::timedOut()
 {
-	while( m_path.endsWith( "/" ) ){
+	m_retryTimer.stop() ;
 
-		m_path = utility::removeLast( m_path,1 ) ;
+	if( m_pendingSignals > 0 && !this->update() ){
+
+		utility::debug() << "Timed out waiting for gvfs folder to update" ;
+
+		m_pendingSignals = 0 ;
 	}
 }
 
-const QString& folderMonitor::path() const
+void dbusMonitor::retry()
 {
-	return m_path ;
+	if( m_pendingSignals > 0 && !this->update() ){
+
+		this->scheduleRetry() ;
+	}
 }
 
-void folderMonitor::contentCountIncreased( folderMonitor::function& function )
+void dbusMonitor::synchronize()
 {
-	auto ss = this->folderListSynced() ;
+	if( !this->update() && !m_timer.isActive() ){
 
-	if( ss.has_value() && ss.value() != m_folderList ){
+		utility::debug() << "Waiting for gvfs folder to update" ;
 
-		auto s = ss.value() ;
+		m_timer.start() ;
 
-		auto e = s ;
+		m_retryInterval = 250 ;
 
-		for( const auto& it : m_folderList ){
+		this->scheduleRetry() ;
+	}
+}
 
-			s.removeOne( it ) ;
-		}
+bool dbusMonitor::update()
+{
+	folderMonitor::function added = [ this ]( const QString& e ){
 
-		for( const auto& it : s ){
+		utility::debug() << "gvfs fuse mount: " + e ;
 
-			function( m_path + "/" + it ) ;
-		}
+		m_function( e ) ;
+	} ;
 
-		m_folderList = std::move( e ) ;
+	folderMonitor::function removed = []( const QString& e ){
+
+		utility::debug() << "gvfs fuse unmount: " + e ;
+	} ;
+
+	if( m_folderMonitor.update( added,removed ) ){
+
+		utility::debug() << "gvfs folder is up to date" ;
+
+		m_pendingSignals = 0 ;
+
+		m_timer.stop() ;
+		m_retryTimer.stop() ;
+
+		return true ;
+	}else{
+		return false ;
 	}
 }
 
-void folderMonitor::contentCountDecreased( folderMonitor::function& function )
+void dbusMonitor::scheduleRetry()
 {
-	auto s = this->folderListSynced() ;
-
-	if( s.has_value() && s.value() != m_folderList ){
-
-		auto e = s.RValue() ;
+	/*
+	 * Never past the time out,it lists the folder one last time itself.
+	 */
+	auto s = qMin( m_retryInterval,m_timer.remainingTime() ) ;
 
-		for( const auto& it : e ){
+	m_retryInterval *= 2 ;
 
-			m_folderList.removeOne( it ) ;
-		}
+	if( s > 0 ){
 
-		for( const auto& it : m_folderList ){
+		m_retryTimer.start( s ) ;
+	}
+}
 
-			function( m_path + "/" + it ) ;
-		}
+folderMonitor::folderMonitor( const QString& path ) : m_path( path )
+{
+	while( m_path.endsWith( "/" ) ){
 
-		m_folderList = std::move( e ) ;
+		m_path = utility::removeLast( m_path,1 ) ;
 	}
+
+	m_folderList = this->folderList() ;
 }
 
-QStringList folderMonitor::folderList() const
+const QString& folderMonitor::path() const
 {
-	return QDir( m_path ).entryList( QDir::NoDotAndDotDot | QDir::Dirs ) ;
+	return m_path ;
 }
 
-utility::qstringlist_result folderMonitor::folderListSynced() const
+bool folderMonitor::update( folderMonitor::function& added,folderMonitor::function& removed )
 {
-	if( m_waitForSynced ){
+	auto s = this->folderList() ;
 
-		for( int i = 0 ; i < 6 ; i++ ){
+	if( s == m_folderList ){
 
-			auto a = this->folderList() ;
+		return false ;
+	}
 
-			if( a != m_folderList ){
+	for( const auto& it : s ){
 
-				utility::debug() << "gvfs folder is up to date" ;
+		if( !m_folderList.contains( it ) ){
 
-				return a ;
-			}else{
-				utility::debug() << "Waiting for gvfs folder to update" ;
+			added( m_path + "/" + it ) ;
+		}
+	}
 
-				utility::Task::suspendForOneSecond() ;
-			}
+	for( const auto& it : m_folderList ){
+
+		if( !s.contains( it ) ){
+
+			removed( m_path + "/" + it ) ;
 		}
+	}
 
-		utility::debug() << "Timed out waiting for gvfs folder to update" ;
+	m_folderList = std::move( s ) ;
+
+	return true ;
+}
+
+QStringList folderMonitor::folderList() const
+{
+	if( m_path.isEmpty() ){
 
 		return {} ;
 	}else{
-		return this->folderList() ;
+		return QDir( m_path ).entryList( QDir::NoDotAndDotDot | QDir::Dirs ) ;
 	}
 }
@@ -26,26 +26,31 @@
 #include <QObject>
 #include <QProcess>
 #include <QVector>
+#include <QHash>
+#include <QTimer>
+#include <QFileSystemWatcher>
 
 #include <functional>
 #include <memory>
+#include <atomic>
 #include <vector>
 
 #include "volumeinfo.h"
+#include "mounttable.h"
+#include "eventmonitor.h"
+
+struct inotify_event ;
 
 class folderMonitor{
 public:
 	using function = std::function< void( const QString& ) > ;
-	folderMonitor( bool wait,const QString& path = QString() ) ;
+	folderMonitor( const QString& path = QString() ) ;
 	const QString& path() const ;
-	void contentCountIncreased( folderMonitor::function& function ) ;
-	void contentCountDecreased( folderMonitor::function& function ) ;
+	bool update( folderMonitor::function& added,folderMonitor::function& removed ) ;
 private:
 	QStringList folderList() const ;
-	utility::qstringlist_result folderListSynced() const ;
 	QString m_path ;
 	QStringList m_folderList ;
-	bool m_waitForSynced ;
 } ;
 
 #ifdef Q_OS_LINUX
@@ -89,6 +94,15 @@ public:
 
 #endif
 
+/*
+ * gvfs tells us through D-Bus that something was mounted or unmounted but the matching
+ * folder in its fuse path shows up a little later,each signal is kept pending until the
+ * folder's content changes or until it times out.
+ *
+ * gvfsd-fuse creates its entries itself and inotify does not always see them,the folder
+ * is therefore also listed again with a growing delay until it changes or until the time
+ * out,where it is listed one last time.
+ */
 class dbusMonitor : public QObject
 {
 	Q_OBJECT
@@ -97,10 +111,21 @@ public:
 private slots:
 	void volumeAdded() ;
 	void volumeRemoved() ;
+	void folderChanged() ;
+	void timedOut() ;
+	void retry() ;
 private:
+	void synchronize() ;
+	bool update() ;
+	void scheduleRetry() ;
 	siriDBus m_dbus ;
 	folderMonitor m_folderMonitor ;
 	folderMonitor::function m_function ;
+	QFileSystemWatcher m_watcher ;
+	QTimer m_timer ;
+	QTimer m_retryTimer ;
+	int m_retryInterval = 0 ;
+	int m_pendingSignals = 0 ;
 } ;
 
 class mountinfo : private QObject
@@ -116,6 +141,26 @@ public:
 
 	static Task::future< std::vector< volumeInfo > >& unlockedVolumes() ;
 
+	/*
+	 * The generation moves forward every time the set of unlocked volumes may have
+	 * changed,unlockedVolumes() reuses its last result until it does.
+	 */
+	static void volumesChanged() ;
+	static quint64 generation() ;
+	static bool waitForNextGeneration( quint64 generation,int milliseconds ) ;
+
+	/*
+	 * Wait for at most "milliseconds" for a volume with the given cipher path or mount
+	 * point to show up in the list of unlocked volumes,returns true if it did.
+	 */
+	static bool waitForVolume( const QString& cipherPath,const QString& mountPoint,int milliseconds ) ;
+
+	/*
+	 * Wait for at most "milliseconds" for a volume at the given mount point to go away
+	 * from the list of unlocked volumes,returns true if it did.
+	 */
+	static bool waitForVolumeRemoval( const QString& mountPoint,int milliseconds ) ;
+
 	mountinfo( QObject * parent,bool,std::function< void() >&& ) ;
 
 	void stop() ;
@@ -129,8 +174,9 @@ private:
 	void windowsMonitor( void ) ;
 	void linuxMonitor( void ) ;
 	void osxMonitor( void ) ;
-	void updateVolume( void ) ;
-	void pbUpdate( void ) ;
+	void updateVolume( int events = 1 ) ;
+	void pbUpdate( const mountTable::delta&,int events ) ;
+	void autoMount( const mountTable::delta& ) ;
 	void autoMount( const QString& ) ;
 	void pollForUpdates( void ) ;
 
@@ -143,8 +189,17 @@ private:
 
 	std::atomic_bool m_exit ;
 
-	QStringList m_oldMountList ;
-	QStringList m_newMountList ;
+	/*
+	 * Raw mount events folded into the next refresh,and running totals of all raw
+	 * events seen and refreshes done.
+	 */
+	std::atomic_int m_pendingEvents{ 0 } ;
+	qint64 m_totalEvents = 0 ;
+	qint64 m_totalRefreshes = 0 ;
+
+	mountTable m_mountTable ;
+
+	eventMonitor m_eventMonitor ;
 
 	dbusMonitor m_dbusMonitor ;
 
@@ -152,31 +207,37 @@ private:
 
 	public:
 		folderMountEvents( std::function< void( const QString& ) > ) ;
-		void start() ;
-		void stop() ;
+		void start( eventMonitor& ) ;
+		void stop( eventMonitor& ) ;
+		void mountTableChanged() ;
 		bool monitor() ;
 	private:
-		class entry{
-		public:
-			entry( int fd,const QString& path ) :
-				m_path( path + "/" ),
-				m_fd( fd )
-			{
-			}
-			~entry() ;
-			const QString& path()
+		/*
+		 * A folder we were asked to watch,"armed" is false when its watch went away
+		 * because the folder was deleted or the file system it lives on was unmounted.
+		 */
+		struct root{
+			root( const QString& p ) : path( p ),armed( false )
 			{
-				return m_path ;
 			}
-			int fd() const
-			{
-				return m_fd ;
-			}
-		private:
-			QString m_path ;
-			int m_fd ;
+			QString path ;
+			bool armed ;
+		} ;
+		struct watch{
+			QString path ;
+			int depth ;
+			int root ;
 		} ;
-		std::vector< mountinfo::folderMountEvents::entry > m_fds ;
+		void addWatch( const QString& path,int depth,int root ) ;
+		void removeWatch( int wd,bool removeFromKernel ) ;
+		void rearm() ;
+		void rescan() ;
+		void processEvents() ;
+		void processEvent( const struct inotify_event * ) ;
+		std::vector< mountinfo::folderMountEvents::root > m_roots ;
+		QHash< int,mountinfo::folderMountEvents::watch > m_watches ;
+		std::vector< char > m_buffer ;
+		int m_maxDepth ;
 		int m_inotify_fd ;
 		std::function< void( const QString& ) > m_update ;
 
@@ -0,0 +1,302 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mountscheduler.h"
+#include "settings.h"
+#include "utility.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+
+/*
+ * How many prepared volumes can wait for their backends to run.
+ */
+static const size_t _prepared_queue_size = 4 ;
+
+mountScheduler::mountScheduler( std::vector< mountScheduler::volume > e )
+{
+	m_nodes.reserve( e.size() ) ;
+
+	for( auto& it : e ){
+
+		auto engine = engines::instance().getByPaths( it.favorite.volumePath,it.favorite.configFilePath ) ;
+
+		const auto& name = engine->name() ;
+
+		auto m = std::find_if( m_lanes.begin(),m_lanes.end(),[ & ]( const mountScheduler::lane& e ){
+
+			return e.engineName == name ;
+		} ) ;
+
+		size_t lane = static_cast< size_t >( m - m_lanes.begin() ) ;
+
+		if( m == m_lanes.end() ){
+
+			int limit = 1 ;
+
+			if( !utility::platformIsWindows() ){
+
+				limit = settings::instance().mountConcurrency( name ) ;
+			}
+
+			m_lanes.push_back( { name,0,limit } ) ;
+		}
+
+		m_waiting.emplace_back( m_nodes.size() ) ;
+
+		m_nodes.push_back( { std::move( it ),std::move( engine ),nullptr,lane } ) ;
+	}
+}
+
+int mountScheduler::run( mountScheduler::function function )
+{
+	m_function = std::move( function ) ;
+
+	for( const auto& it : m_nodes ){
+
+		if( it.engine->known() && it.engine->requiresPolkit() ){
+
+			/*
+			 * Start siripolkit here and not from jobs that may race each other
+			 * doing it.
+			 */
+			utility::enablePolkit() ;
+
+			break ;
+		}
+	}
+
+	QElapsedTimer timer ;
+
+	timer.start() ;
+
+	this->start() ;
+
+	if( m_running > 0 ){
+
+		m_loop.exec() ;
+	}
+
+	auto s = QString( "Unlocked %1 volumes in %2 ms,time spent preparing: %3 ms,running backends: %4 ms,finishing: %5 ms" ) ;
+
+	auto a = QString::number( m_nodes.size() - static_cast< size_t >( m_failed ) ) ;
+	auto b = QString::number( timer.elapsed() ) ;
+	auto c = QString::number( m_prepareTime ) ;
+	auto d = QString::number( m_spawnTime ) ;
+	auto e = QString::number( m_finishTime ) ;
+
+	utility::debug() << s.arg( a,b,c,d,e ) ;
+
+	return m_failed ;
+}
+
+void mountScheduler::start()
+{
+	if( utility::platformIsWindows() ){
+
+		/*
+		 * Windows volumes are tracked by objects that belong to this thread.
+		 */
+		while( !m_waiting.empty() ){
+
+			auto index = m_waiting.front() ;
+
+			m_waiting.pop_front() ;
+
+			auto& node = m_nodes[ index ] ;
+
+			engines::engine::cmdArgsList opts( node.volume.favorite,node.volume.key ) ;
+
+			node.stages = std::make_shared< siritask::mountStages >( siritask::mount{ opts,false,node.engine } ) ;
+
+			auto& s = *node.stages ;
+
+			if( s.prepare() && s.spawn() ){
+
+				s.finish() ;
+			}
+
+			m_prepareTime += s.prepareTime() ;
+			m_spawnTime   += s.spawnTime() ;
+			m_finishTime  += s.finishTime() ;
+
+			this->finished( index ) ;
+		}
+
+		return ;
+	}
+
+	this->startFinish() ;
+	this->startSpawn() ;
+	this->startPrepare() ;
+
+	if( m_running == 0 ){
+
+		m_loop.quit() ;
+	}
+}
+
+void mountScheduler::startPrepare()
+{
+	if( m_preparing || m_waiting.empty() || m_prepared.size() >= _prepared_queue_size ){
+
+		return ;
+	}
+
+	auto index = m_waiting.front() ;
+
+	m_waiting.pop_front() ;
+
+	auto& node = m_nodes[ index ] ;
+
+	engines::engine::cmdArgsList opts( node.volume.favorite,node.volume.key ) ;
+
+	node.stages = std::make_shared< siritask::mountStages >( siritask::mount{ opts,false,node.engine } ) ;
+
+	auto stages = node.stages ;
+
+	m_preparing = true ;
+	m_running++ ;
+
+	Task::run_io( [ stages ](){
+
+		return stages->prepare() ;
+
+	} ).then( [ this,index ]( bool s ){
+
+		m_preparing = false ;
+		m_running-- ;
+
+		m_prepareTime += m_nodes[ index ].stages->prepareTime() ;
+
+		if( s ){
+
+			m_prepared.emplace_back( index ) ;
+		}else{
+			this->finished( index ) ;
+		}
+
+		this->start() ;
+	} ) ;
+}
+
+void mountScheduler::startSpawn()
+{
+	auto it = m_prepared.begin() ;
+
+	while( it != m_prepared.end() ){
+
+		auto index = *it ;
+
+		auto& lane = m_lanes[ m_nodes[ index ].lane ] ;
+
+		if( lane.running >= lane.limit ){
+
+			it++ ;
+
+			continue ;
+		}
+
+		it = m_prepared.erase( it ) ;
+
+		auto stages = m_nodes[ index ].stages ;
+
+		lane.running++ ;
+		m_running++ ;
+
+		Task::run_io( [ stages ](){
+
+			return stages->spawn() ;
+
+		} ).then( [ this,index ]( bool s ){
+
+			m_lanes[ m_nodes[ index ].lane ].running-- ;
+			m_running-- ;
+
+			m_spawnTime += m_nodes[ index ].stages->spawnTime() ;
+
+			if( s ){
+
+				m_spawned.emplace_back( index ) ;
+			}else{
+				this->finished( index ) ;
+			}
+
+			this->start() ;
+		} ) ;
+	}
+}
+
+void mountScheduler::startFinish()
+{
+	if( m_finishing || m_spawned.empty() ){
+
+		return ;
+	}
+
+	auto index = m_spawned.front() ;
+
+	m_spawned.pop_front() ;
+
+	auto stages = m_nodes[ index ].stages ;
+
+	m_finishing = true ;
+	m_running++ ;
+
+	Task::run_io( [ stages ](){
+
+		stages->finish() ;
+
+	} ).then( [ this,index ](){
+
+		m_finishing = false ;
+		m_running-- ;
+
+		m_finishTime += m_nodes[ index ].stages->finishTime() ;
+
+		this->finished( index ) ;
+
+		this->start() ;
+	} ) ;
+}
+
+void mountScheduler::finished( size_t index )
+{
+	const auto& node = m_nodes[ index ] ;
+	const auto& s = node.stages->status() ;
+
+	auto m = QString( "\"%1\": %2,prepare: %3 ms,backend: %4 ms,finish: %5 ms" ) ;
+
+	auto a = node.volume.favorite.volumePath ;
+	auto b = s.toMiniString() ;
+	auto c = QString::number( node.stages->prepareTime() ) ;
+	auto d = QString::number( node.stages->spawnTime() ) ;
+	auto e = QString::number( node.stages->finishTime() ) ;
+
+	utility::debug() << m.arg( a,b,c,d,e ) ;
+
+	if( s != engines::engine::status::success ){
+
+		m_failed++ ;
+	}
+
+	m_function( { node.volume.favorite,node.volume.key,s } ) ;
+}
@@ -0,0 +1,116 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MOUNT_SCHEDULER_H
+#define MOUNT_SCHEDULER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QEventLoop>
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <memory>
+
+#include "engines.h"
+#include "favorites.h"
+#include "siritask.h"
+
+/*
+ * Unlocks a list of favorites as a pipeline.
+ *
+ * Mounting a volume is split into the stages of siritask::mountStages.Volumes are
+ * prepared one at a time ahead of the backends that will mount them and a few prepared
+ * volumes wait in a queue for their turn,the preparing stops when the queue is full.
+ * Backends run concurrently with every engine getting its own limit of how many of its
+ * volumes can be unlocked at the same time,the limits come from
+ * settings::mountConcurrency().Mounted volumes are then finished one at a time.
+ *
+ * The time every volume spends in each stage is logged.On Windows,volumes go through
+ * all the stages one at a time.
+ */
+class mountScheduler
+{
+public:
+	struct volume{
+
+		favorites::entry favorite ;
+		QByteArray key ;
+	} ;
+
+	struct result{
+
+		const favorites::entry& favorite ;
+		const QByteArray& key ;
+		const engines::engine::cmdStatus& status ;
+	} ;
+
+	using function = std::function< void( const mountScheduler::result& ) > ;
+
+	mountScheduler( std::vector< mountScheduler::volume > ) ;
+
+	/*
+	 * Returns after every volume got its turn,events are processed in the meantime.
+	 * "function" is called on the calling thread with the result of each volume as it
+	 * comes in.
+	 *
+	 * Returns the number of volumes that were not unlocked.
+	 */
+	int run( mountScheduler::function ) ;
+private:
+	struct node{
+
+		mountScheduler::volume volume ;
+		engines::engineWithPaths engine ;
+		std::shared_ptr< siritask::mountStages > stages ;
+		size_t lane ;
+	} ;
+
+	struct lane{
+
+		QString engineName ;
+		int running ;
+		int limit ;
+	} ;
+
+	void start() ;
+	void startPrepare() ;
+	void startSpawn() ;
+	void startFinish() ;
+	void finished( size_t ) ;
+
+	std::vector< mountScheduler::node > m_nodes ;
+	std::vector< mountScheduler::lane > m_lanes ;
+	std::deque< size_t > m_waiting ;
+	std::deque< size_t > m_prepared ;
+	std::deque< size_t > m_spawned ;
+	mountScheduler::function m_function ;
+	QEventLoop m_loop ;
+	bool m_preparing = false ;
+	bool m_finishing = false ;
+	int m_running = 0 ;
+	int m_failed = 0 ;
+	qint64 m_prepareTime = 0 ;
+	qint64 m_spawnTime = 0 ;
+	qint64 m_finishTime = 0 ;
+} ;
+
+#endif
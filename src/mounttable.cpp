@@ -0,0 +1,262 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mounttable.h"
+
+static bool _is_number( const QString& e,int end )
+{
+	if( end <= 0 ){
+
+		return false ;
+	}
+
+	for( int i = 0 ; i < end ; i++ ){
+
+		auto c = e.at( i ) ;
+
+		if( c < '0' || c > '9' ){
+
+			return false ;
+		}
+	}
+
+	return true ;
+}
+
+mountTable::entry::entry( const QString& line ) : m_line( line )
+{
+	/*
+	 * We are only interested in the first and the fifth field.
+	 */
+	int field = 0 ;
+	int start = 0 ;
+	int firstFieldEnd = -1 ;
+
+	for( int i = 0 ; i <= m_line.size() ; i++ ){
+
+		if( i == m_line.size() || m_line.at( i ) == ' ' ){
+
+			if( field == 0 ){
+
+				firstFieldEnd = i ;
+
+			}else if( field == 4 ){
+
+				m_mountPoint = m_line.mid( start,i - start ) ;
+				break ;
+			}
+
+			field++ ;
+			start = i + 1 ;
+		}
+	}
+
+	if( _is_number( m_line,firstFieldEnd ) ){
+
+		m_key = m_line.mid( 0,firstFieldEnd ) ;
+	}else{
+		m_key = "mp:" + m_mountPoint ;
+	}
+}
+
+mountTable::mountTable()
+{
+}
+
+mountTable::mountTable( const QStringList& e )
+{
+	m_entries.reserve( static_cast< size_t >( e.size() ) ) ;
+	m_index.reserve( e.size() ) ;
+
+	for( const auto& it : e ){
+
+		if( !it.isEmpty() ){
+
+			this->add( it ) ;
+		}
+	}
+}
+
+void mountTable::add( mountTable::entry e )
+{
+	if( m_index.contains( e.m_key ) ){
+
+		/*
+		 * Two entries with the same key can only happen with entries we
+		 * generated ourselves,fall back to using the full line as a key.
+		 */
+		e.m_key = "line:" + e.m_line ;
+
+		if( m_index.contains( e.m_key ) ){
+
+			return ;
+		}
+	}
+
+	m_index.insert( e.m_key,m_entries.size() ) ;
+	m_entries.emplace_back( std::move( e ) ) ;
+}
+
+const mountTable::entry * mountTable::find( const QString& key ) const
+{
+	auto it = m_index.find( key ) ;
+
+	if( it == m_index.end() ){
+
+		return nullptr ;
+	}else{
+		return &m_entries[ it.value() ] ;
+	}
+}
+
+QStringList mountTable::lines() const
+{
+	QStringList s ;
+
+	s.reserve( this->size() ) ;
+
+	for( const auto& it : m_entries ){
+
+		s.append( it.line() ) ;
+	}
+
+	return s ;
+}
+
+mountTable::delta mountTable::diff( const mountTable& newer ) const
+{
+	mountTable::delta s ;
+
+	for( const auto& it : newer.m_entries ){
+
+		auto e = this->find( it.key() ) ;
+
+		if( e == nullptr ){
+
+			s.added.emplace_back( it ) ;
+
+		}else if( e->mountPoint() != it.mountPoint() ){
+
+			/*
+			 * The kernel reuses mount IDs,a different mount point under the
+			 * same ID means the old volume is gone and a new one took its place.
+			 */
+			s.added.emplace_back( it ) ;
+
+		}else if( e->line() != it.line() ){
+
+			s.changed.emplace_back( it ) ;
+		}
+	}
+
+	for( const auto& it : m_entries ){
+
+		auto e = newer.find( it.key() ) ;
+
+		if( e == nullptr || e->mountPoint() != it.mountPoint() ){
+
+			s.removed.emplace_back( it ) ;
+		}
+	}
+
+	return s ;
+}
+
+bool mountTable::field::startsWith( const char * e,int size ) const
+{
+	return m_size >= size && std::memcmp( m_data,e,static_cast< size_t >( size ) ) == 0 ;
+}
+
+bool mountTable::field::equals( const char * e,int size ) const
+{
+	return m_size == size && std::memcmp( m_data,e,static_cast< size_t >( size ) ) == 0 ;
+}
+
+bool mountTable::field::equalsCaseInsensitive( const QByteArray& e ) const
+{
+	return m_size == e.size() && qstrnicmp( m_data,e.constData(),static_cast< uint >( m_size ) ) == 0 ;
+}
+
+bool mountTable::parseLine( const char * start,const char * end,mountTable::fields& s )
+{
+	/*
+	 * Field layout:
+	 * ID parentID major:minor root mountPoint mountOptions [optional fields...] - fileSystem device superOptions
+	 */
+	s = mountTable::fields() ;
+
+	int index = 0 ;
+	int afterSeparator = -1 ;
+
+	const char * it = start ;
+
+	while( it < end ){
+
+		auto m = static_cast< const char * >( std::memchr( it,' ',static_cast< size_t >( end - it ) ) ) ;
+
+		if( m == nullptr ){
+
+			m = end ;
+		}
+
+		mountTable::field f( it,static_cast< int >( m - it ) ) ;
+
+		if( afterSeparator == -1 ){
+
+			if( index == 0 ){
+
+				s.mountId = f ;
+
+			}else if( index == 4 ){
+
+				s.mountPoint = f ;
+
+			}else if( index == 5 ){
+
+				s.mountOptions = f ;
+
+			}else if( index > 5 && f.equals( "-",1 ) ){
+
+				afterSeparator = 0 ;
+			}
+		}else{
+			if( afterSeparator == 0 ){
+
+				s.fileSystem = f ;
+
+			}else if( afterSeparator == 1 ){
+
+				s.device = f ;
+
+			}else if( afterSeparator == 2 ){
+
+				s.superOptions = f ;
+
+				return true ;
+			}
+
+			afterSeparator++ ;
+		}
+
+		index++ ;
+		it = m + 1 ;
+	}
+
+	return false ;
+}
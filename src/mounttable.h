@@ -0,0 +1,179 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOUNT_TABLE_H
+#define MOUNT_TABLE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QByteArray>
+
+#include <vector>
+#include <cstring>
+
+/*
+ * A snapshot of the mount table.
+ *
+ * Entries are keyed by mount ID(the first field of /proc/self/mountinfo).Lines we
+ * generate ourselves through mountinfo::mountProperties() have "x" as their mount ID
+ * and these are keyed by their mount point instead.
+ *
+ * Comparing two snapshots gives back what was added,removed or changed between them
+ * in linear time.
+ */
+class mountTable
+{
+public:
+	class entry
+	{
+	public:
+		entry( const QString& line ) ;
+		const QString& key() const
+		{
+			return m_key ;
+		}
+		const QString& line() const
+		{
+			return m_line ;
+		}
+		const QString& mountPoint() const
+		{
+			return m_mountPoint ;
+		}
+	private:
+		friend class mountTable ;
+		QString m_line ;
+		QString m_key ;
+		QString m_mountPoint ;
+	} ;
+
+	class delta
+	{
+	public:
+		bool isEmpty() const
+		{
+			return added.empty() && removed.empty() && changed.empty() ;
+		}
+		bool isNotEmpty() const
+		{
+			return !this->isEmpty() ;
+		}
+		std::vector< mountTable::entry > added ;
+		std::vector< mountTable::entry > removed ;
+		std::vector< mountTable::entry > changed ;
+	} ;
+
+	/*
+	 * A non owning view into a line of the mount table.It stays valid only for as
+	 * long as the buffer it points into is alive.
+	 */
+	class field
+	{
+	public:
+		field() : m_data( nullptr ),m_size( 0 )
+		{
+		}
+		field( const char * data,int size ) : m_data( data ),m_size( size )
+		{
+		}
+		bool isEmpty() const
+		{
+			return m_size == 0 ;
+		}
+		bool startsWith( const char * e,int size ) const ;
+		bool equals( const char * e,int size ) const ;
+		bool equalsCaseInsensitive( const QByteArray& e ) const ;
+		QString toString() const
+		{
+			return QString::fromUtf8( m_data,m_size ) ;
+		}
+		QByteArray toByteArray() const
+		{
+			return QByteArray( m_data,m_size ) ;
+		}
+	private:
+		const char * m_data ;
+		int m_size ;
+	} ;
+
+	struct fields
+	{
+		mountTable::field mountId ;
+		mountTable::field mountPoint ;
+		mountTable::field mountOptions ;
+		mountTable::field fileSystem ;
+		mountTable::field device ;
+		mountTable::field superOptions ;
+	} ;
+
+	/*
+	 * Walk a buffer in /proc/self/mountinfo format line by line without allocating,
+	 * "function" is called with the fields of every well formed line.
+	 */
+	template< typename Function >
+	static void parse( const QByteArray& e,Function&& function )
+	{
+		const char * it  = e.constData() ;
+		const char * end = it + e.size() ;
+
+		mountTable::fields s ;
+
+		while( it < end ){
+
+			auto m = static_cast< const char * >( std::memchr( it,'\n',static_cast< size_t >( end - it ) ) ) ;
+
+			if( m == nullptr ){
+
+				m = end ;
+			}
+
+			if( mountTable::parseLine( it,m,s ) ){
+
+				function( s ) ;
+			}
+
+			it = m + 1 ;
+		}
+	}
+	static bool parseLine( const char * start,const char * end,mountTable::fields& ) ;
+
+	mountTable() ;
+	mountTable( const QStringList& ) ;
+
+	mountTable::delta diff( const mountTable& newer ) const ;
+
+	const mountTable::entry * find( const QString& key ) const ;
+
+	const std::vector< mountTable::entry >& entries() const
+	{
+		return m_entries ;
+	}
+	QStringList lines() const ;
+	int size() const
+	{
+		return static_cast< int >( m_entries.size() ) ;
+	}
+private:
+	void add( mountTable::entry ) ;
+	std::vector< mountTable::entry > m_entries ;
+	QHash< QString,std::vector< mountTable::entry >::size_type > m_index ;
+};
+
+#endif
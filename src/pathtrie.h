@@ -0,0 +1,212 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PATH_TRIE_H
+#define PATH_TRIE_H
+
+#include <QString>
+
+#include <map>
+#include <set>
+#include <memory>
+#include <vector>
+
+/*
+ * Values keyed by paths and stored in a tree of path components.
+ *
+ * Looking up a path costs one step per component of the path and everything stored at
+ * or under a path comes back without looking at anything stored elsewhere.Separators
+ * at the start,the end or repeated in the middle of a path do not matter,"/a//b/" and
+ * "/a/b" are the same path.
+ */
+template< typename T >
+class pathTrie
+{
+public:
+	void insert( const QString& path,T value )
+	{
+		auto m = &m_root ;
+
+		int position = 0 ;
+
+		QString component ;
+
+		while( pathTrie::next( path,position,component ) ){
+
+			auto& s = m->children[ component ] ;
+
+			if( !s ){
+
+				s.reset( new pathTrie::node() ) ;
+			}
+
+			m = s.get() ;
+		}
+
+		m->values.insert( std::move( value ) ) ;
+	}
+	void remove( const QString& path,const T& value )
+	{
+		std::vector< std::pair< pathTrie::node *,QString > > parents ;
+
+		auto m = &m_root ;
+
+		int position = 0 ;
+
+		QString component ;
+
+		while( pathTrie::next( path,position,component ) ){
+
+			auto it = m->children.find( component ) ;
+
+			if( it == m->children.end() ){
+
+				return ;
+			}
+
+			parents.emplace_back( m,component ) ;
+
+			m = it->second.get() ;
+		}
+
+		m->values.erase( value ) ;
+
+		/*
+		 * Drop nodes that no longer lead to anything.
+		 */
+		while( !parents.empty() && m->values.empty() && m->children.empty() ){
+
+			auto& s = parents.back() ;
+
+			m = s.first ;
+
+			m->children.erase( s.second ) ;
+
+			parents.pop_back() ;
+		}
+	}
+	/*
+	 * Values stored at exactly "path",null if there are none.
+	 */
+	const std::set< T > * find( const QString& path ) const
+	{
+		auto m = this->node_at( path ) ;
+
+		if( m && !m->values.empty() ){
+
+			return &m->values ;
+		}else{
+			return nullptr ;
+		}
+	}
+	bool contains( const QString& path ) const
+	{
+		return this->find( path ) != nullptr ;
+	}
+	/*
+	 * Call "function" with every value stored at "path" or under it.
+	 */
+	template< typename Function >
+	void forEachUnder( const QString& path,Function&& function ) const
+	{
+		auto m = this->node_at( path ) ;
+
+		if( m ){
+
+			pathTrie::walk( *m,function ) ;
+		}
+	}
+	void clear()
+	{
+		m_root.children.clear() ;
+		m_root.values.clear() ;
+	}
+private:
+	struct node{
+
+		std::map< QString,std::unique_ptr< pathTrie::node > > children ;
+		std::set< T > values ;
+	} ;
+
+	static bool next( const QString& path,int& position,QString& component )
+	{
+		while( position < path.size() && path.at( position ) == '/' ){
+
+			position++ ;
+		}
+
+		if( position >= path.size() ){
+
+			return false ;
+		}
+
+		auto end = path.indexOf( '/',position ) ;
+
+		if( end == -1 ){
+
+			end = path.size() ;
+		}
+
+		component = path.mid( position,end - position ) ;
+
+		position = end ;
+
+		return true ;
+	}
+	const pathTrie::node * node_at( const QString& path ) const
+	{
+		auto m = &m_root ;
+
+		int position = 0 ;
+
+		QString component ;
+
+		while( pathTrie::next( path,position,component ) ){
+
+			auto it = m->children.find( component ) ;
+
+			if( it == m->children.end() ){
+
+				return nullptr ;
+			}
+
+			m = it->second.get() ;
+		}
+
+		return m ;
+	}
+	template< typename Function >
+	static void walk( const pathTrie::node& m,Function& function )
+	{
+		for( const auto& it : m.values ){
+
+			function( it ) ;
+		}
+
+		for( const auto& it : m.children ){
+
+			pathTrie::walk( *it.second,function ) ;
+		}
+	}
+
+	pathTrie::node m_root ;
+} ;
+
+#endif
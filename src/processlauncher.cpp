@@ -0,0 +1,597 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "processlauncher.h"
+
+#ifdef Q_OS_LINUX
+
+#include <spawn.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+#include <mutex>
+
+extern char ** environ ;
+
+class fileDescriptor
+{
+public:
+	fileDescriptor() : m_fd( -1 )
+	{
+	}
+	fileDescriptor( const fileDescriptor& ) = delete ;
+	fileDescriptor& operator=( const fileDescriptor& ) = delete ;
+	~fileDescriptor()
+	{
+		this->close() ;
+	}
+	int get() const
+	{
+		return m_fd ;
+	}
+	bool valid() const
+	{
+		return m_fd != -1 ;
+	}
+	void reset( int fd )
+	{
+		this->close() ;
+		m_fd = fd ;
+	}
+	void close()
+	{
+		if( m_fd != -1 ){
+
+			::close( m_fd ) ;
+			m_fd = -1 ;
+		}
+	}
+private:
+	int m_fd ;
+} ;
+
+/*
+ * Storage for a NULL terminated array of C strings as expected by posix_spawn().
+ */
+class cStringList
+{
+public:
+	void append( QByteArray e )
+	{
+		m_storage.emplace_back( std::move( e ) ) ;
+	}
+	char * const * data()
+	{
+		m_pointers.clear() ;
+
+		for( auto& it : m_storage ){
+
+			m_pointers.emplace_back( it.data() ) ;
+		}
+
+		m_pointers.emplace_back( nullptr ) ;
+
+		return m_pointers.data() ;
+	}
+private:
+	std::vector< QByteArray > m_storage ;
+	std::vector< char * > m_pointers ;
+} ;
+
+/*
+ * The end of the pipe we keep is made non blocking,the end the child gets is left
+ * alone since O_NONBLOCK is shared with every copy of a file descriptor.
+ */
+static bool _pipe( fileDescriptor& ours,fileDescriptor& theirs,bool weRead )
+{
+	int fds[ 2 ] ;
+
+	if( pipe2( fds,O_CLOEXEC ) != 0 ){
+
+		return false ;
+	}
+
+	if( weRead ){
+
+		ours.reset( fds[ 0 ] ) ;
+		theirs.reset( fds[ 1 ] ) ;
+	}else{
+		ours.reset( fds[ 1 ] ) ;
+		theirs.reset( fds[ 0 ] ) ;
+	}
+
+	fcntl( ours.get(),F_SETFL,fcntl( ours.get(),F_GETFL ) | O_NONBLOCK ) ;
+
+	return true ;
+}
+
+/*
+ * A file descriptor that becomes readable when the process exits,it is not available
+ * on kernels older than 5.3 and we fall back to checking periodically.
+ */
+static int _pidfd_open( pid_t pid )
+{
+#ifdef SYS_pidfd_open
+	return static_cast< int >( syscall( SYS_pidfd_open,pid,0 ) ) ;
+#else
+	Q_UNUSED( pid )
+	return -1 ;
+#endif
+}
+
+/*
+ * Writing to the standard input of a program that already exited would otherwise kill
+ * us with SIGPIPE,QProcess does the same thing.
+ */
+static void _ignore_sigpipe()
+{
+	static std::once_flag once ;
+
+	std::call_once( once,[](){
+
+		struct sigaction e ;
+
+		if( sigaction( SIGPIPE,nullptr,&e ) == 0 && e.sa_handler == SIG_DFL ){
+
+			e.sa_handler = SIG_IGN ;
+
+			sigaction( SIGPIPE,&e,nullptr ) ;
+		}
+	} ) ;
+}
+
+/*
+ * Read everything that is currently available,the file descriptor is closed on end of
+ * file or on error.
+ */
+static void _read( fileDescriptor& fd,QByteArray& buffer )
+{
+	char data[ 4096 ] ;
+
+	while( fd.valid() ){
+
+		auto s = read( fd.get(),data,sizeof( data ) ) ;
+
+		if( s > 0 ){
+
+			buffer.append( data,static_cast< int >( s ) ) ;
+
+		}else if( s == -1 && errno == EINTR ){
+
+			continue ;
+
+		}else if( s == -1 && errno == EAGAIN ){
+
+			break ;
+		}else{
+			fd.close() ;
+		}
+	}
+}
+
+static void _write( fileDescriptor& fd,const QByteArray& buffer,int& offset )
+{
+	while( fd.valid() && offset < buffer.size() ){
+
+		auto s = write( fd.get(),buffer.constData() + offset,static_cast< size_t >( buffer.size() - offset ) ) ;
+
+		if( s > 0 ){
+
+			offset += static_cast< int >( s ) ;
+
+		}else if( s == -1 && errno == EINTR ){
+
+			continue ;
+
+		}else if( s == -1 && errno == EAGAIN ){
+
+			return ;
+		}else{
+			fd.close() ;
+		}
+	}
+
+	fd.close() ;
+}
+
+/*
+ * A running child process and the parent's ends of its standard streams.
+ */
+class childProcess
+{
+public:
+	childProcess( const QByteArray& password ) : m_password( password )
+	{
+	}
+	int start( const QString& exe,const QStringList& args,const QProcessEnvironment& env ) ;
+	bool exited() ;
+	bool poll( int timeOut ) ;
+	void kill() ;
+	bool failed() const
+	{
+		return m_failed ;
+	}
+	const QByteArray& output() const
+	{
+		return m_output ;
+	}
+	const QByteArray& error() const
+	{
+		return m_error ;
+	}
+	::Task::process::result result( bool finished ) ;
+private:
+	pid_t m_pid = -1 ;
+	int m_status = 0 ;
+	int m_passwordOffset = 0 ;
+	bool m_exited = false ;
+	bool m_failed = false ;
+	QByteArray m_password ;
+	QByteArray m_output ;
+	QByteArray m_error ;
+	fileDescriptor m_stdIn ;
+	fileDescriptor m_stdOut ;
+	fileDescriptor m_stdError ;
+	fileDescriptor m_processExited ;
+} ;
+
+int childProcess::start( const QString& exe,const QStringList& args,const QProcessEnvironment& env )
+{
+	fileDescriptor childStdIn ;
+	fileDescriptor childStdOut ;
+	fileDescriptor childStdError ;
+
+	if( !_pipe( m_stdOut,childStdOut,true ) || !_pipe( m_stdError,childStdError,true ) ){
+
+		return errno ;
+	}
+
+	if( !m_password.isEmpty() && !_pipe( m_stdIn,childStdIn,false ) ){
+
+		return errno ;
+	}
+
+	posix_spawn_file_actions_t actions ;
+
+	posix_spawn_file_actions_init( &actions ) ;
+
+	if( m_password.isEmpty() ){
+
+		posix_spawn_file_actions_addopen( &actions,0,"/dev/null",O_RDONLY,0 ) ;
+	}else{
+		posix_spawn_file_actions_adddup2( &actions,childStdIn.get(),0 ) ;
+	}
+
+	posix_spawn_file_actions_adddup2( &actions,childStdOut.get(),1 ) ;
+	posix_spawn_file_actions_adddup2( &actions,childStdError.get(),2 ) ;
+
+	/*
+	 * Give the child default signal handlers and an empty signal mask since both are
+	 * inherited through exec.
+	 */
+	posix_spawnattr_t attributes ;
+
+	posix_spawnattr_init( &attributes ) ;
+
+	sigset_t signals ;
+
+	sigemptyset( &signals ) ;
+	posix_spawnattr_setsigmask( &attributes,&signals ) ;
+
+	sigaddset( &signals,SIGPIPE ) ;
+	posix_spawnattr_setsigdefault( &attributes,&signals ) ;
+
+	posix_spawnattr_setflags( &attributes,POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF ) ;
+
+	cStringList arguments ;
+
+	arguments.append( exe.toLocal8Bit() ) ;
+
+	for( const auto& it : args ){
+
+		arguments.append( it.toLocal8Bit() ) ;
+	}
+
+	cStringList environment ;
+
+	for( const auto& it : env.toStringList() ){
+
+		environment.append( it.toLocal8Bit() ) ;
+	}
+
+	auto argv = arguments.data() ;
+	auto envp = env.isEmpty() ? environ : environment.data() ;
+
+	auto r = posix_spawnp( &m_pid,argv[ 0 ],&actions,&attributes,argv,envp ) ;
+
+	posix_spawn_file_actions_destroy( &actions ) ;
+	posix_spawnattr_destroy( &attributes ) ;
+
+	if( r == 0 ){
+
+		m_processExited.reset( _pidfd_open( m_pid ) ) ;
+	}
+
+	return r ;
+}
+
+bool childProcess::exited()
+{
+	if( !m_exited && waitpid( m_pid,&m_status,WNOHANG ) == m_pid ){
+
+		m_exited = true ;
+
+		_read( m_stdOut,m_output ) ;
+		_read( m_stdError,m_error ) ;
+	}
+
+	return m_exited ;
+}
+
+/*
+ * Wait for at most "timeOut" milliseconds for something to happen and return true if
+ * new output arrived.
+ */
+bool childProcess::poll( int timeOut )
+{
+	if( !m_processExited.valid() && ( timeOut == -1 || timeOut > 50 ) ){
+
+		timeOut = 50 ;
+	}
+
+	struct pollfd fds[ 4 ] ;
+
+	nfds_t count = 0 ;
+
+	auto _add = [ & ]( const fileDescriptor& e,short events ){
+
+		if( e.valid() ){
+
+			fds[ count ].fd      = e.get() ;
+			fds[ count ].events  = events ;
+			fds[ count ].revents = 0 ;
+
+			count++ ;
+		}
+	} ;
+
+	_add( m_stdIn,POLLOUT ) ;
+	_add( m_stdOut,POLLIN ) ;
+	_add( m_stdError,POLLIN ) ;
+	_add( m_processExited,POLLIN ) ;
+
+	if( ::poll( fds,count,timeOut ) == -1 ){
+
+		if( errno != EINTR ){
+
+			m_failed = true ;
+		}
+
+		return false ;
+	}
+
+	auto size = m_output.size() + m_error.size() ;
+
+	for( nfds_t i = 0 ; i < count ; i++ ){
+
+		const auto& it = fds[ i ] ;
+
+		if( it.revents == 0 ){
+
+			continue ;
+		}
+
+		if( it.fd == m_stdIn.get() ){
+
+			if( it.revents & POLLOUT ){
+
+				_write( m_stdIn,m_password,m_passwordOffset ) ;
+			}else{
+				m_stdIn.close() ;
+			}
+
+		}else if( it.fd == m_stdOut.get() ){
+
+			_read( m_stdOut,m_output ) ;
+
+		}else if( it.fd == m_stdError.get() ){
+
+			_read( m_stdError,m_error ) ;
+		}
+	}
+
+	return m_output.size() + m_error.size() != size ;
+}
+
+void childProcess::kill()
+{
+	if( !m_exited ){
+
+		::kill( m_pid,SIGKILL ) ;
+
+		while( waitpid( m_pid,&m_status,0 ) == -1 && errno == EINTR ){}
+
+		m_exited = true ;
+	}
+}
+
+::Task::process::result childProcess::result( bool finished )
+{
+	if( WIFEXITED( m_status ) ){
+
+		return { std::move( m_output ),std::move( m_error ),WEXITSTATUS( m_status ),QProcess::NormalExit,finished } ;
+	}else{
+		return { std::move( m_output ),std::move( m_error ),255,QProcess::CrashExit,finished } ;
+	}
+}
+
+static int _time_left( std::chrono::steady_clock::time_point e )
+{
+	using ms = std::chrono::milliseconds ;
+
+	auto s = std::chrono::duration_cast< ms >( e - std::chrono::steady_clock::now() ).count() ;
+
+	return s > 0 ? static_cast< int >( s ) : 0 ;
+}
+
+::Task::process::result processLauncher::run( const QString& exe,
+					      const QStringList& args,
+					      int waitTime,
+					      const QByteArray& password,
+					      const QProcessEnvironment& env )
+{
+	return processLauncher::run( exe,args,waitTime,password,env,nullptr ) ;
+}
+
+::Task::process::result processLauncher::run( const QString& exe,
+					      const QStringList& args,
+					      int waitTime,
+					      const QByteArray& password,
+					      const QProcessEnvironment& env,
+					      const processLauncher::monitor& monitor )
+{
+	_ignore_sigpipe() ;
+
+	childProcess process( password ) ;
+
+	auto r = process.start( exe,args,env ) ;
+
+	if( r != 0 ){
+
+		QByteArray e = "SiriKali: Failed To Start Program: " ;
+
+		return ::Task::process::result( QByteArray(),e + strerror( r ),255,255,false ) ;
+	}
+
+	using clock = std::chrono::steady_clock ;
+
+	auto deadline = clock::now() + std::chrono::milliseconds( waitTime ) ;
+	auto graceDeadline = clock::time_point() ;
+
+	auto state = processLauncher::action::proceed ;
+
+	/*
+	 * Like QProcess,we are done when the process exits and not when its output pipes
+	 * are closed since backends that fork into the background pass them to their child.
+	 */
+	while( !process.exited() ){
+
+		int timeOut = -1 ;
+
+		if( state == processLauncher::action::failed ){
+
+			timeOut = _time_left( graceDeadline ) ;
+
+			if( timeOut == 0 ){
+
+				process.kill() ;
+
+				return process.result( true ) ;
+			}
+		}
+
+		if( waitTime >= 0 ){
+
+			auto s = _time_left( deadline ) ;
+
+			if( s == 0 ){
+
+				process.kill() ;
+
+				return process.result( false ) ;
+			}
+
+			if( timeOut == -1 || s < timeOut ){
+
+				timeOut = s ;
+			}
+		}
+
+		auto newOutput = process.poll( timeOut ) ;
+
+		if( process.failed() ){
+
+			process.kill() ;
+
+			return process.result( false ) ;
+		}
+
+		if( newOutput && monitor && state == processLauncher::action::proceed ){
+
+			state = monitor( process.output(),process.error() ) ;
+
+			if( state == processLauncher::action::failed ){
+
+				graceDeadline = clock::now() + std::chrono::milliseconds( 300 ) ;
+			}
+		}
+	}
+
+	return process.result( true ) ;
+}
+
+#else
+
+#include <QProcess>
+
+::Task::process::result processLauncher::run( const QString& exe,
+					      const QStringList& args,
+					      int waitTime,
+					      const QByteArray& password,
+					      const QProcessEnvironment& env )
+{
+	QProcess s ;
+
+	if( !env.isEmpty() ){
+
+		s.setProcessEnvironment( env ) ;
+	}
+
+	s.start( exe,args ) ;
+
+	if( !password.isEmpty() ){
+
+		s.waitForStarted( waitTime ) ;
+		s.write( password ) ;
+		s.closeWriteChannel() ;
+	}
+
+	return ::Task::process::result( s,waitTime ) ;
+}
+
+::Task::process::result processLauncher::run( const QString& exe,
+					      const QStringList& args,
+					      int waitTime,
+					      const QByteArray& password,
+					      const QProcessEnvironment& env,
+					      const processLauncher::monitor& monitor )
+{
+	Q_UNUSED( monitor )
+	return processLauncher::run( exe,args,waitTime,password,env ) ;
+}
+
+#endif
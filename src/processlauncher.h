@@ -0,0 +1,75 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCESS_LAUNCHER_H
+#define PROCESS_LAUNCHER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QProcessEnvironment>
+
+#include <functional>
+
+#include "task.hpp"
+
+/*
+ * A light weight alternative to QProcess for running backends and helper programs.
+ *
+ * QProcess forks the whole GUI process and sets up socket notifiers for every child,
+ * this class starts programs with posix_spawn() and collects their output through
+ * pipes from the calling thread.
+ *
+ * "password" is written to the program's standard input which is then closed,an
+ * empty password gives the program an already closed standard input.
+ *
+ * A negative "waitTime" means wait forever,the program is killed if it is still
+ * running when "waitTime" milliseconds expire and the result is marked as not finished.
+ *
+ * An empty "env" means the program inherits our environment.
+ *
+ * A monitor gets called with everything the program wrote so far every time new output
+ * arrives,it decides if the outcome is already known.Once it returns "failed",the
+ * program is given 300 milliseconds to exit on its own to keep its exit code and it is
+ * killed if it does not.Once it returns anything other than "proceed",it is not called
+ * again.
+ *
+ * On platforms other than Linux,QProcess is used and monitors are not called.
+ */
+class processLauncher
+{
+public:
+	enum class action{ proceed,succeeded,failed } ;
+
+	using monitor = std::function< processLauncher::action( const QByteArray& std_out,const QByteArray& std_error ) > ;
+
+	static ::Task::process::result run( const QString& exe,
+					    const QStringList& args,
+					    int waitTime = -1,
+					    const QByteArray& password = QByteArray(),
+					    const QProcessEnvironment& env = QProcessEnvironment() ) ;
+	static ::Task::process::result run( const QString& exe,
+					    const QStringList& args,
+					    int waitTime,
+					    const QByteArray& password,
+					    const QProcessEnvironment& env,
+					    const processLauncher::monitor& ) ;
+} ;
+
+#endif
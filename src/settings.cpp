@@ -21,6 +21,7 @@
 #include <QApplication>
 #include <QWidget>
 #include <QDialog>
+#include <QThread>
 
 #include "engines.h"
 #include "settings.h"
@@ -45,6 +46,7 @@
 #include <iostream>
 
 #include <QByteArray>
+#include <QSet>
 #include <QTranslator>
 
 #include <QCoreApplication>
@@ -118,6 +120,97 @@ int settings::pollForUpdatesInterval()
 	return m_settings.value( "WinFSPpollingInterval" ).toInt() ;
 }
 
+int settings::mountEventsQuietWindow()
+{
+	if( !m_settings.contains( "MountEventsQuietWindow" ) ){
+
+		m_settings.setValue( "MountEventsQuietWindow",100 ) ;
+	}
+
+	return m_settings.value( "MountEventsQuietWindow" ).toInt() ;
+}
+
+int settings::mountEventsMaxLatency()
+{
+	if( !m_settings.contains( "MountEventsMaxLatency" ) ){
+
+		m_settings.setValue( "MountEventsMaxLatency",1000 ) ;
+	}
+
+	return m_settings.value( "MountEventsMaxLatency" ).toInt() ;
+}
+
+int settings::mountReadyTimeOut()
+{
+	if( !m_settings.contains( "MountReadyTimeOut" ) ){
+
+		m_settings.setValue( "MountReadyTimeOut",5000 ) ;
+	}
+
+	return m_settings.value( "MountReadyTimeOut" ).toInt() ;
+}
+
+int settings::unMountConcurrency()
+{
+	if( !m_settings.contains( "UnMountConcurrency" ) ){
+
+		m_settings.setValue( "UnMountConcurrency",4 ) ;
+	}
+
+	return m_settings.value( "UnMountConcurrency" ).toInt() ;
+}
+
+int settings::unMountRemovalTimeOut()
+{
+	if( !m_settings.contains( "UnMountRemovalTimeOut" ) ){
+
+		m_settings.setValue( "UnMountRemovalTimeOut",5000 ) ;
+	}
+
+	return m_settings.value( "UnMountRemovalTimeOut" ).toInt() ;
+}
+
+int settings::emergencyShutDownTimeOut()
+{
+	if( !m_settings.contains( "EmergencyShutDownTimeOut" ) ){
+
+		m_settings.setValue( "EmergencyShutDownTimeOut",10000 ) ;
+	}
+
+	return m_settings.value( "EmergencyShutDownTimeOut" ).toInt() ;
+}
+
+int settings::mountConcurrency( const QString& engineName )
+{
+	auto key = "MountConcurrency_" + engineName ;
+
+	if( !m_settings.contains( key ) ){
+
+		/*
+		 * Unlocking is mostly key derivation work for local backends,sshfs
+		 * mostly waits on the network and on servers that limit connections.
+		 */
+		if( engineName == "sshfs" ){
+
+			m_settings.setValue( key,4 ) ;
+		}else{
+			m_settings.setValue( key,qMax( QThread::idealThreadCount(),1 ) ) ;
+		}
+	}
+
+	return qMax( m_settings.value( key ).toInt(),1 ) ;
+}
+
+bool settings::favoritesSingleFileStore()
+{
+	if( !m_settings.contains( "FavoritesSingleFileStore" ) ){
+
+		m_settings.setValue( "FavoritesSingleFileStore",false ) ;
+	}
+
+	return m_settings.value( "FavoritesSingleFileStore" ).toBool() ;
+}
+
 int settings::sshfsBackendTimeout()
 {
 	if( !m_settings.contains( "sshfsBackendTimeout" ) ){
@@ -459,6 +552,16 @@ QStringList settings::mountMonitorFolderPaths()
 	return m_settings.value( "MountMonitorFolderPaths" ).toStringList() ;
 }
 
+int settings::mountMonitorFolderDepth()
+{
+	if( !m_settings.contains( "MountMonitorFolderDepth" ) ){
+
+		m_settings.setValue( "MountMonitorFolderDepth",0 ) ;
+	}
+
+	return m_settings.value( "MountMonitorFolderDepth" ).toInt() ;
+}
+
 QStringList settings::supportedFileSystemsOnMountPaths()
 {
 	if( !m_settings.contains( "SupportedFileSystemsOnMountPaths" ) ){
@@ -510,29 +613,7 @@ bool settings::readFavorites( QMenu * m )
 
 	const auto favorites = favorites::instance().readFavorites() ;
 
-	bool cipherPathRepeatsInFavoritesList = false ;
-
-	for( auto it = favorites.begin() ; it != favorites.end() ; it++ ){
-
-		for( auto xt = it + 1 ; xt != favorites.end() ; xt++ ){
-
-			if( ( *it ).volumePath == ( *xt ).volumePath ){
-
-				cipherPathRepeatsInFavoritesList = true ;
-				break ;
-			}
-		}
-	}
-
-	auto _showCipherPathAndMountPath = [ & ](){
-
-		if( cipherPathRepeatsInFavoritesList ){
-
-			return true ;
-		}else{
-			return settings().instance().showCipherFolderAndMountPathInFavoritesList() ;
-		}
-	}() ;
+	auto _showCipherPathAndMountPath = this->showCipherFolderAndMountPathInFavoritesList( favorites ) ;
 
 	if( _showCipherPathAndMountPath ){
 
@@ -555,6 +636,28 @@ bool settings::readFavorites( QMenu * m )
 	return _showCipherPathAndMountPath ;
 }
 
+bool settings::showCipherFolderAndMountPathInFavoritesList( const std::vector< favorites::entry >& e )
+{
+	/*
+	 * A cipher folder that appears more than once can only be told apart by its mount point.
+	 */
+	QSet< QString > s ;
+
+	s.reserve( static_cast< int >( e.size() ) ) ;
+
+	for( const auto& it : e ){
+
+		if( s.contains( it.volumePath ) ){
+
+			return true ;
+		}else{
+			s.insert( it.volumePath ) ;
+		}
+	}
+
+	return this->showCipherFolderAndMountPathInFavoritesList() ;
+}
+
 void settings::setDefaultMountPointPrefix( const QString& path )
 {
 	m_settings.setValue( "MountPrefix",path ) ;
@@ -128,6 +128,14 @@ public:
 	settings() ;
 	bool showCipherFolderAndMountPathInFavoritesList() ;
 	int pollForUpdatesInterval() ;
+	int mountEventsQuietWindow() ;
+	int mountEventsMaxLatency() ;
+	int mountReadyTimeOut() ;
+	int unMountConcurrency() ;
+	int unMountRemovalTimeOut() ;
+	int emergencyShutDownTimeOut() ;
+	int mountConcurrency( const QString& engineName ) ;
+	bool favoritesSingleFileStore() ;
 	int sshfsBackendTimeout() ;
 	void setWindowsExecutableSearchPath( const QString& ) ;
 	QString windowsExecutableSearchPath() ;
@@ -202,6 +210,7 @@ public:
 	bool setOpenVolumeReadOnly( QWidget * parent,bool checked ) ;
 	bool getOpenVolumeReadOnlyOption() ;
 	bool readFavorites( QMenu * m ) ;
+	bool showCipherFolderAndMountPathInFavoritesList( const std::vector< favorites::entry >& ) ;
 	QString localizationLanguagePath() ;
 	void languageMenu( QMenu * m,QAction * ac,settings::translator& ) ;
 	void setLocalizationLanguage( bool translate,QMenu * m,settings::translator& ) ;
@@ -210,6 +219,7 @@ public:
 	int readPasswordMaximumLength() ;
 	bool unMountVolumesOnLogout( void ) ;
 	QStringList mountMonitorFolderPaths( void ) ;
+	int mountMonitorFolderDepth( void ) ;
 	QStringList supportedFileSystemsOnMountPaths( void ) ;
 	QString gvfsFuseMonitorPath( void ) ;
 	int mountMonitorFolderPollingInterval( void ) ;
@@ -23,7 +23,8 @@
 
 #include <QMainWindow>
 
-#include <QTableWidgetItem>
+#include <QTableView>
+#include <QHeaderView>
 #include <QDir>
 #include <QIcon>
 #include <QAction>
@@ -49,10 +50,11 @@
 #include "createbackendwindow.h"
 #include "filemanager.h"
 #include "dialogmsg.h"
-#include "tablewidget.h"
 #include "oneinstance.h"
 #include "utility.h"
 #include "siritask.h"
+#include "unmountscheduler.h"
+#include "mountscheduler.h"
 #include "checkforupdates.h"
 #include "favorites.h"
 #include "plugins.h"
@@ -63,6 +65,7 @@
 #include "json.h"
 #include "settings.h"
 #include "engines.h"
+#include "processlauncher.h"
 
 #include "favorites2.h"
 #include "favorites.h"
@@ -130,6 +133,10 @@ configOptions::functions sirikali::configOption()
 
 			it->setText( m_translator.translate( it->objectName() ) ) ;
 		}
+
+		m_favoritesMenu.retranslate() ;
+
+		m_volumes.retranslate() ;
 	} ;
 
 	return { std::move( a ),std::move( b ) } ;
@@ -141,7 +148,7 @@ void sirikali::closeApplication( int s,const QString& e )
 
 	if( utility::platformIsWindows() && m_ui && !m_emergencyShuttingDown ){
 
-		if( m_ui->tableWidget->rowCount() > 0 ){
+		if( m_volumes.size() > 0 ){
 
 			auto m = tr( "Close All Volumes Before Quitting The Application" ) ;
 			return DialogMsg( this ).ShowUIOK( tr( "WARNING" ),m ) ;
@@ -173,6 +180,8 @@ void sirikali::closeApplication( int s,const QString& e )
 
 void sirikali::setUpApp( const QString& volume )
 {
+	engines::instance().warmUpVersions() ;
+
 	this->setLocalizationLanguage( true ) ;
 
 	m_signalHandler.listen() ;
@@ -188,7 +197,9 @@ void sirikali::setUpApp( const QString& volume )
 	m_ui->pbupdate->setMinimumHeight( 31 ) ;
 	m_ui->pbFavorites->setMinimumHeight( 31 ) ;
 
-	auto table = m_ui->tableWidget ;
+	auto table = m_ui->tableView ;
+
+	table->setModel( &m_volumes ) ;
 
 	const auto dimensions = settings::instance().getWindowDimensions() ;
 
@@ -199,34 +210,31 @@ void sirikali::setUpApp( const QString& volume )
 	table->setColumnWidth( 2,dimensions.columnWidthAt( 2 ) ) ;
 	table->setColumnWidth( 3,dimensions.columnWidthAt( 3 ) ) ;
 
-	m_ui->tableWidget->verticalHeader()->setSectionResizeMode( QHeaderView::ResizeToContents ) ;
+	table->verticalHeader()->setSectionResizeMode( QHeaderView::ResizeToContents ) ;
 
-	m_ui->tableWidget->verticalHeader()->setMinimumSectionSize( 30 ) ;
+	table->verticalHeader()->setMinimumSectionSize( 30 ) ;
 
-	m_ui->tableWidget->setMouseTracking( true ) ;
+	table->setMouseTracking( true ) ;
 
-	m_ui->tableWidget->setContextMenuPolicy( Qt::CustomContextMenu ) ;
+	table->setContextMenuPolicy( Qt::CustomContextMenu ) ;
 
-	connect( m_ui->tableWidget,&QTableWidget::customContextMenuRequested,[ this ]( QPoint s ){
+	connect( table,&QTableView::customContextMenuRequested,[ this ]( QPoint s ){
 
 		Q_UNUSED( s )
 
-		auto item = m_ui->tableWidget->currentItem() ;
+		auto row = this->currentRow() ;
 
-		if( item ){
+		if( row != -1 ){
 
-			this->showContextMenu( item,true ) ;
+			this->showContextMenu( row,true ) ;
 		}
 	} ) ;
 
-	connect( m_ui->tableWidget,SIGNAL( currentItemChanged( QTableWidgetItem *,QTableWidgetItem * ) ),
-		 this,SLOT( slotCurrentItemChanged( QTableWidgetItem *,QTableWidgetItem * ) ) ) ;
-
 	connect( m_ui->pbupdate,SIGNAL( clicked() ),
 		 this,SLOT( pbUpdate() ) ) ;
 
-	connect( m_ui->tableWidget,SIGNAL( itemClicked( QTableWidgetItem * ) ),
-		 this,SLOT( itemClicked( QTableWidgetItem * ) ) ) ;
+	connect( table,SIGNAL( clicked( QModelIndex ) ),
+		 this,SLOT( itemClicked( QModelIndex ) ) ) ;
 
 	if( engines::instance().atLeastOneDealsWithFiles() ){
 
@@ -319,7 +327,7 @@ void sirikali::setUpApp( const QString& volume )
 		this->autoMount( volume ) ;
 	}
 
-	this->startGUI( m ) ;
+	this->startGUI() ;
 
 	if( utility::platformIsNOTWindows() ){
 
@@ -591,7 +599,7 @@ void sirikali::setLocalizationLanguage( bool translate )
 	settings::instance().setLocalizationLanguage( translate,&m_language_menu,m_translator ) ;
 }
 
-void sirikali::startGUI( const std::vector< volumeInfo >& m )
+void sirikali::startGUI()
 {
 	if( !m_startHidden ){
 
@@ -600,7 +608,7 @@ void sirikali::startGUI( const std::vector< volumeInfo >& m )
 
 	if( settings::instance().autoMountFavoritesOnStartUp() ){
 
-		this->autoUnlockVolumes( m ) ;
+		this->autoUnlockVolumes() ;
 	}
 
 	utility::applicationStarted() ;
@@ -917,11 +925,15 @@ void sirikali::autoMountFavoritesOnAvailable( QString m )
 
 		favorites::volumeList e ;
 
-		for( auto&& it : _readFavorites() ){
+		for( auto&& it : favorites::instance().readFavoritesUnder( m ) ){
 
-			if( it.first.volumePath.startsWith( m ) && it.first.autoMount.True() ){
+			/*
+			 * "m" can be a whole watched folder after its events were lost,skip
+			 * what is already mounted.
+			 */
+			if( it.autoMount.True() && m_volumes.rows( it.volumePath ).empty() ){
 
-				e.emplace_back( std::move( it ) ) ;
+				e.emplace_back( std::move( it ),QByteArray() ) ;
 			}
 		}
 
@@ -929,28 +941,15 @@ void sirikali::autoMountFavoritesOnAvailable( QString m )
 	}
 }
 
-void sirikali::autoUnlockVolumes( const std::vector< volumeInfo >& s )
+void sirikali::autoUnlockVolumes()
 {
 	favorites::volumeList e ;
 
-	auto _mounted = [ & ]( const QString& e ){
-
-		for( const auto& it : s ){
-
-			if( it.volumePath() == e ){
-
-				return true ;
-			}
-		}
-
-		return false ;
-	} ;
-
 	for( auto&& it : _readFavorites() ){
 
 		const auto& m = it.first ;
 
-		if( m.autoMount.True() && !_mounted( m.volumePath )){
+		if( m.autoMount.True() && m_volumes.rows( m.volumePath ).empty() ){
 
 			e.emplace_back( std::move( it ) ) ;
 		}
@@ -987,70 +986,73 @@ favorites::volumeList sirikali::autoUnlockVolumes( favorites::volumeList l,bool
 
 	favorites::volumeList e ;
 
-	auto _mount = [ & ]( favorites::volumeList& q,
-			     const std::pair< favorites::entry,QByteArray >& e,
-			     const QByteArray& key,
-			     bool s ){
-		if( s ){
+	std::vector< mountScheduler::volume > volumes ;
 
-			q.emplace_back( e.first,key ) ;
-		}else{
-			this->disableAll() ;
+	auto s = settings::instance().showMountDialogWhenAutoMounting() ;
 
-			auto s = siritask::encryptedFolderMount( { e.first,key } ) ;
+	for( const auto& it : l ){
 
-			if( s == engines::engine::status::success ){
+		const auto key = m->readValue( it.first.volumePath ) ;
 
-				if( autoOpenFolderOnMount ){
+		if( key.isEmpty() ){
 
-					this->openMountPointPath( e.first.mountPointPath ) ;
-				}
+			e.emplace_back( it ) ;
 
-				if( !s.engine().autorefreshOnMountUnMount() ){
+		}else if( s ){
 
-					this->updateList() ;
-				}
-			}else{
-				q.emplace_back( e.first,key ) ;
+			e.emplace_back( it.first,key ) ;
+		}else{
+			volumes.push_back( { it.first,key } ) ;
+		}
+	}
 
-				utility::debug() << "Automounting has failed because: " + s.toString() ;
-			}
+	if( volumes.empty() ){
 
-			this->enableAll() ;
-		}
-	} ;
+		return e ;
+	}
 
-	auto s = settings::instance().showMountDialogWhenAutoMounting() ;
+	this->disableAll() ;
 
-	for( const auto& it : l ){
+	m_mountInfo.announceEvents( false ) ;
 
-		const auto key = m->readValue( it.first.volumePath ) ;
+	mountScheduler scheduler( std::move( volumes ) ) ;
 
-		if( key.isEmpty() ){
+	scheduler.run( [ & ]( const mountScheduler::result& r ){
 
-			e.emplace_back( it ) ;
+		if( r.status == engines::engine::status::success ){
+
+			if( autoOpenFolderOnMount ){
+
+				this->openMountPointPath( r.favorite.mountPointPath ) ;
+			}
 		}else{
-			_mount( e,it,key,s ) ;
+			e.emplace_back( r.favorite,r.key ) ;
+
+			utility::debug() << "Automounting has failed because: " + r.status.toString() ;
 		}
-	}
+	} ) ;
+
+	this->updateList() ;
+
+	m_mountInfo.announceEvents( true ) ;
+
+	this->enableAll() ;
 
 	return e ;
 }
 
 void sirikali::volumeProperties()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = this->currentRow() ;
 
-	auto row = table->currentRow() ;
+	if( row == -1 ){
 
-	QString cipherPath ;
-	QString mountPath ;
-	QString volumeType ;
+		return ;
+	}
 
-	utility2::stringListToStrings( tablewidget::rowEntries( table,row ),
-				       cipherPath,
-				       mountPath,
-				       volumeType ) ;
+	auto cipherPath = m_volumes.at( row ).volumePath ;
+	auto mountPath  = m_volumes.at( row ).mountPoint ;
+	auto volumeType = m_volumes.at( row ).fileSystem ;
 
 	const auto& engine = engines::instance().getByName( volumeType ) ;
 
@@ -1070,11 +1072,17 @@ void sirikali::genericVolumeProperties()
 
 	if( utility::platformIsWindows() ){
 
-		auto table = m_ui->tableWidget ;
+		auto row = this->currentRow() ;
+
+		auto m = [ & ](){
 
-		auto row = table->currentRow() ;
+			if( row == -1 ){
 
-		auto m = SiriKali::Windows::volumeProperties( table->item( row,1 )->text() ) ;
+				return QString() ;
+			}else{
+				return SiriKali::Windows::volumeProperties( m_volumes.at( row ).mountPoint ) ;
+			}
+		}() ;
 
 		if( m.isEmpty() ){
 
@@ -1088,13 +1096,11 @@ void sirikali::genericVolumeProperties()
 
 	auto s = [ this ](){
 
-		auto table = m_ui->tableWidget ;
+		auto row = this->currentRow() ;
 
-		auto item = table->currentItem() ;
+		if( row != -1 ){
 
-		if( item ){
-
-			return table->item( item->row(),1 )->text() ;
+			return m_volumes.at( row ).mountPoint ;
 		}else{
 			return QString() ;
 		}
@@ -1123,7 +1129,7 @@ void sirikali::genericVolumeProperties()
 	this->enableAll() ;
 }
 
-void sirikali::showContextMenu( QTableWidgetItem * item,bool itemClicked )
+void sirikali::showContextMenu( int row,bool itemClicked )
 {
 	QMenu m ;
 
@@ -1156,8 +1162,8 @@ void sirikali::showContextMenu( QTableWidgetItem * item,bool itemClicked )
 	}else{
 		auto p = this->pos() ;
 
-		auto x = p.x() + 100 + m_ui->tableWidget->columnWidth( 0 ) ;
-		auto y = p.y() + 50 + m_ui->tableWidget->rowHeight( 0 ) * item->row() ;
+		auto x = p.x() + 100 + m_ui->tableView->columnWidth( 0 ) ;
+		auto y = p.y() + 50 + m_ui->tableView->rowHeight( 0 ) * row ;
 
 		p.setX( x ) ;
 		p.setY( y ) ;
@@ -1167,39 +1173,34 @@ void sirikali::showContextMenu( QTableWidgetItem * item,bool itemClicked )
 
 void sirikali::addToFavorites()
 {
-	auto table = m_ui->tableWidget ;
-
-	int s = table->currentRow() ;
+	int s = this->currentRow() ;
 
 	if( s == -1 ){
 
 		return ;
 	}
 
-	auto cp = tablewidget::rowEntries( table,s ) ;
+	const auto& e = m_volumes.at( s ) ;
 
-	if( cp.size() > 0 ){
+	favorites2::instance( this,m_secrets,[ this ](){
 
-		favorites2::instance( this,m_secrets,[ this ](){
-
-			this->updateFavoritesInContextMenu() ;
+		this->updateFavoritesInContextMenu() ;
 
-		},cp.at( 2 ),cp.at( 0 ) ) ;
-	}
+	},e.fileSystem,e.volumePath ) ;
 }
 
-void sirikali::itemClicked( QTableWidgetItem * item )
+void sirikali::itemClicked( const QModelIndex& index )
 {
-	this->showContextMenu( item,true ) ;
+	this->showContextMenu( index.row(),true ) ;
 }
 
 void sirikali::defaultButton()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = this->currentRow() ;
 
-	if( table->rowCount() > 0 ){
+	if( row != -1 ){
 
-		this->showContextMenu( table->currentItem(),false ) ;
+		this->showContextMenu( row,false ) ;
 	}
 }
 
@@ -1210,12 +1211,11 @@ void sirikali::slotOpenSharedFolder()
 
 void sirikali::slotOpenFolder()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = this->currentRow() ;
 
-	if( table->rowCount() > 0 ){
+	if( row != -1 ){
 
-		auto item = table->currentItem() ;
-		auto path = table->item( item->row(),1 )->text() ;
+		auto path = m_volumes.at( row ).mountPoint ;
 
 		if( utility::platformIsWindows() ){
 
@@ -1228,12 +1228,11 @@ void sirikali::slotOpenFolder()
 
 void sirikali::slotOpenParentFolder()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = this->currentRow() ;
 
-	if( table->rowCount() > 0 ){
+	if( row != -1 ){
 
-		auto item = table->currentItem() ;
-		auto path = table->item( item->row(),1 )->text() ;
+		auto path = m_volumes.at( row ).mountPoint ;
 
 		if( utility::platformIsWindows() ){
 
@@ -1500,87 +1499,6 @@ QFont sirikali::getSystemVolumeFont()
 
 void sirikali::updateFavoritesInContextMenu()
 {
-	class mountedVolumes{
-	public:
-		mountedVolumes( QTableWidget * table ) :
-			m_cipherPath( tablewidget::columnEntries( table,0 ) ),
-			m_mountPath( tablewidget::columnEntries( table,1 ) )
-		{
-		}
-		int row( const QString& e )
-		{
-			auto a = utility::split( e,'\n' ) ;
-
-			if( a.size() == 1 ){
-
-				const auto& m = a.at( 0 ) ;
-
-				for( int i = 0 ; i < m_cipherPath.size() ; i++ ){
-
-					if( m == m_cipherPath.at( i ) ){
-
-						return i ;
-					}
-				}
-			}else{
-				const auto& x = a.at( 0 ) ;
-				const auto& y = a.at( 1 ) ;
-
-				for( int i = 0 ; i < m_cipherPath.size() ; i++ ){
-
-					if( x == m_cipherPath.at( i ) && y == m_mountPath.at( i ) ){
-
-						return i ;
-					}
-				}
-			}
-
-			return -1 ;
-		}
-
-		bool mounted( const QString& e )
-		{
-			auto s = this->row( e ) ;
-
-			if( s == -1 ){
-
-				return false ;
-			}else{
-				m_cipherPath.removeAt( s ) ;
-				m_mountPath.removeAt( s ) ;
-
-				return true ;
-			}
-		}
-
-		void addMounted( QMenu * m,bool e )
-		{
-			for( int i = 0 ; i < m_cipherPath.size() ; i++ ){
-
-				auto ac = new QAction( m ) ;
-
-				QString n ;
-
-				if( e ){
-
-					n = m_cipherPath.at( i ) + "\n" + m_mountPath.at( i ) ;
-				}else{
-					n = m_cipherPath.at( i ) ;
-				}
-
-				ac->setText( n ) ;
-				ac->setObjectName( n ) ;
-				ac->setCheckable( true ) ;
-				ac->setChecked( true ) ;
-
-				m->addAction( ac ) ;
-			}
-		}
-	private:
-		QStringList m_cipherPath ;
-		QStringList m_mountPath ;
-	};
-
 	if( !settings::instance().showFavoritesInContextMenu() ){
 
 		return ;
@@ -1598,11 +1516,11 @@ void sirikali::updateFavoritesInContextMenu()
 
 					this->favoriteClicked( ac ) ;
 				}else{
-					auto b = mountedVolumes( m_ui->tableWidget ).row( ac->objectName() ) ;
+					auto b = m_volumes.row( ac->data().toString() ) ;
 
 					if( b != -1 ){
 
-						tablewidget::selectRow( m_ui->tableWidget,b ) ;
+						this->selectRow( b ) ;
 						this->pbUmount() ;
 					}
 				}
@@ -1614,24 +1532,7 @@ void sirikali::updateFavoritesInContextMenu()
 		m_trayIcon.setContextMenu( m_context_menu ) ;
 	}
 
-	auto e = settings::instance().readFavorites( m_context_menu ) ;
-
-	auto s = m_context_menu->actions() ;
-
-	mountedVolumes m( m_ui->tableWidget ) ;
-
-	for( int i = 2 ; i < s.size() ; i++ ){
-
-		auto it = s.at( i ) ;
-		it->setCheckable( true ) ;
-		it->setChecked( m.mounted( it->objectName() ) ) ;
-	}
-
-	m.addMounted( m_context_menu,e ) ;
-
-	m_context_menu->addSeparator() ;
-
-	m_context_menu->addActions( m_main_menu->actions() ) ;
+	m_favoritesMenu.update( m_context_menu,m_volumes,m_main_menu->actions() ) ;
 }
 
 void sirikali::runIntervalCustomCommand( const QString& cmd )
@@ -1654,7 +1555,7 @@ void sirikali::runIntervalCustomCommand( const QString& cmd )
 			}
 		}
 
-		Task::exec( [ = ](){
+		Task::run_io( [ = ](){
 
 			const auto& e = utility::systemEnvironment() ;
 
@@ -1662,63 +1563,43 @@ void sirikali::runIntervalCustomCommand( const QString& cmd )
 
 				if( key.isEmpty() ){
 
-					return Task::process::run( cmd,args,-1,{},e ).get() ;
+					return processLauncher::run( cmd,args,-1,{},e ) ;
 				}else{
 					auto s = e ;
 
 					s.insert( settings::instance().environmentalVariableVolumeKey(),key ) ;
 
-					return Task::process::run( cmd,args,-1,{},s ).get() ;
+					return processLauncher::run( cmd,args,-1,{},s ) ;
 				}
 			}() ;
 
 			utility::logCommandOutPut( r,cmd,args ) ;
-		} ) ;
+		} ).start() ;
 	} ) ;
 }
 
-void sirikali::addEntryToTable( const QStringList& l )
-{
-	tablewidget::addRow( m_ui->tableWidget,l ) ;
-}
-
-void sirikali::addEntryToTable( const volumeInfo& e )
-{
-	this->addEntryToTable( e.mountInfo().minimalList() ) ;
-}
-
-void sirikali::removeEntryFromTable( QString volume )
+int sirikali::currentRow()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = m_ui->tableView->currentIndex().row() ;
 
-	auto r = tablewidget::columnHasEntry( table,volume ) ;
+	if( row >= 0 && row < m_volumes.size() ){
 
-	if( r != -1 ){
-
-		tablewidget::deleteRow( table,r ) ;
-		this->enableAll() ;
+		return row ;
 	}else{
-		this->pbUpdate() ;
+		return -1 ;
 	}
 }
 
-void sirikali::updateList( const volumeInfo& entry )
+void sirikali::selectRow( int row )
 {
-	if( entry.isValid() ){
-
-		auto table = m_ui->tableWidget ;
+	auto table = m_ui->tableView ;
 
-		auto row = tablewidget::columnHasEntry( table,entry.mountPoint(),1 ) ;
+	if( row >= 0 && row < m_volumes.size() ){
 
-		if( row == -1 ){
-
-			row = tablewidget::addRow( table ) ;
-		}
-
-		tablewidget::updateRow( table,entry.mountInfo().minimalList(),row,this->font() ) ;
-
-		tablewidget::selectRow( table,row ) ;
+		table->selectRow( row ) ;
 	}
+
+	table->setFocus() ;
 }
 
 engines::engine::cmdStatus sirikali::unMountVolume( const sirikali::mountedEntry& e )
@@ -1735,19 +1616,15 @@ engines::engine::cmdStatus sirikali::unMountVolume( const sirikali::mountedEntry
 
 void sirikali::pbUmount()
 {
-	auto table = m_ui->tableWidget ;
+	auto row = this->currentRow() ;
 
-	if( table->rowCount() > 0 ){
+	if( row != -1 ){
 
 		this->disableAll() ;
 
-		auto row = table->currentRow() ;
-
-		auto type = table->item( row,2 )->text() ;
-
-		auto a = table->item( row,0 )->text() ;
-		auto b = table->item( row,1 )->text() ;
-		auto c = table->item( row,2 )->text() ;
+		auto a = m_volumes.at( row ).volumePath ;
+		auto b = m_volumes.at( row ).mountPoint ;
+		auto c = m_volumes.at( row ).fileSystem ;
 
 		utility::waitForOneSecond() ;
 
@@ -1774,19 +1651,14 @@ void sirikali::pbUmount()
 
 void sirikali::processMountedVolumes( std::function< void( const sirikali::mountedEntry& ) > function )
 {
-	auto table = m_ui->tableWidget ;
-
-	const auto cipherFolders = tablewidget::columnEntries( table,0 ) ;
-	const auto mountPoints   = tablewidget::columnEntries( table,1 ) ;
-	const auto fileSystems   = tablewidget::columnEntries( table,2 ) ;
-
-	for( auto r = cipherFolders.size() - 1 ; r >= 0 ; r-- ){
+	/*
+	 * A copy,"function" may end up changing the list.
+	 */
+	const auto volumes = m_volumes.entries() ;
 
-		const auto& a = cipherFolders.at( r ) ;
-		const auto& b = mountPoints.at( r ) ;
-		const auto& c = fileSystems.at( r ) ;
+	for( auto it = volumes.rbegin() ; it != volumes.rend() ; it++ ){
 
-		function( { a,b,c } ) ;
+		function( { it->volumePath,it->mountPoint,it->fileSystem } ) ;
 	}
 }
 
@@ -1798,10 +1670,33 @@ void sirikali::emergencyShutDown()
 
 	m_mountInfo.announceEvents( false ) ;
 
-	this->processMountedVolumes( [ this ]( const sirikali::mountedEntry& e ){
+	if( utility::platformIsWindows() ){
+
+		this->processMountedVolumes( [ this ]( const sirikali::mountedEntry& e ){
 
-		this->unMountVolume( e ) ;
-	} ) ;
+			this->unMountVolume( e ) ;
+		} ) ;
+
+		return this->closeApplication( 0,"Emergency shut down" ) ;
+	}
+
+	std::vector< siritask::unmount > volumes ;
+
+	for( const auto& it : m_volumes.entries() ){
+
+		volumes.push_back( { it.volumePath,it.mountPoint,it.fileSystem,1 } ) ;
+	}
+
+	auto timeOut = settings::instance().emergencyShutDownTimeOut() ;
+
+	for( const auto& it : siritask::emergencyUnMount( volumes,timeOut ) ){
+
+		const auto& m = volumes[ it ] ;
+
+		auto s = QString( "Emergency shut down left \"%1\" mounted at \"%2\"(%3)" ) ;
+
+		utility::debug::cerr() << s.arg( m.cipherFolder,m.mountPoint,m.fileSystem ) ;
+	}
 
 	this->closeApplication( 0,"Emergency shut down" ) ;
 }
@@ -1812,27 +1707,42 @@ void sirikali::unMountAll()
 
 	this->disableAll() ;
 
-	utility::waitForOneSecond() ;
+	std::vector< unmountScheduler::volume > volumes ;
 
-	this->processMountedVolumes( [ this ]( const mountedEntry& e ){
+	this->processMountedVolumes( [ & ]( const mountedEntry& e ){
 
-		if( this->unMountVolume( e ).success() ){
+		volumes.push_back( { e.cipherPath,e.mountPoint,e.volumeType } ) ;
+	} ) ;
 
-			tablewidget::deleteRow( m_ui->tableWidget,e.mountPoint,1 ) ;
+	unmountScheduler scheduler( std::move( volumes ),settings::instance().unMountConcurrency() ) ;
 
-			utility::waitForOneSecond() ;
+	QStringList failed ;
+
+	auto m = scheduler.run( [ & ]( const unmountScheduler::result& e ){
+
+		if( e.blocked ){
+
+			auto s = tr( "A volume mounted inside it could not be unmounted." ) ;
+
+			failed.append( e.volume.mountPoint + ": " + s ) ;
+
+		}else if( e.status.success() ){
+
+			m_volumes.remove( e.volume.mountPoint ) ;
+		}else{
+			failed.append( e.volume.mountPoint + ": " + e.status.toString() ) ;
 		}
 	} ) ;
 
-	auto m = m_ui->tableWidget->rowCount() ;
-
 	if( m > 0 ){
 
+		auto s = failed.join( "\n\n" ) ;
+
 		if( m == 1 ){
 
-			DialogMsg( this ).ShowUIOK( tr( "WARNING" ),tr( "Failed To Unmount 1 Volume." ) ) ;
+			DialogMsg( this ).ShowUIOK( tr( "WARNING" ),tr( "Failed To Unmount 1 Volume." ) + "\n\n" + s ) ;
 		}else{
-			DialogMsg( this ).ShowUIOK( tr( "WARNING" ),tr( "Failed To Unmount %1 Volumes." ).arg( m ) ) ;
+			DialogMsg( this ).ShowUIOK( tr( "WARNING" ),tr( "Failed To Unmount %1 Volumes." ).arg( m ) + "\n\n" + s ) ;
 		}
 	}
 
@@ -1847,7 +1757,7 @@ void sirikali::unMountAllAndQuit()
 {
 	this->unMountAll() ;
 
-	if( m_ui->tableWidget->rowCount() == 0 ){
+	if( m_volumes.size() == 0 ){
 
 		this->closeApplication() ;
 	}
@@ -1874,28 +1784,23 @@ void sirikali::pbUpdate()
 
 void sirikali::updateVolumeList( const std::vector< volumeInfo >& r )
 {
-	tablewidget::clearTable( m_ui->tableWidget ) ;
+	m_volumes.update( r ) ;
 
-	for( const auto& it : r ){
+	if( this->currentRow() == -1 ){
 
-		this->updateList( it ) ;
+		this->selectRow( m_volumes.size() - 1 ) ;
 	}
 
 	this->enableAll() ;
 }
 
-void sirikali::slotCurrentItemChanged( QTableWidgetItem * current,QTableWidgetItem * previous )
-{
-	tablewidget::selectRow( current,previous ) ;
-}
-
 void sirikali::disableAll()
 {
 	if( !utility::platformIsOSX() ){
 
 		m_ui->pbmenu->setEnabled( false ) ;
 		m_ui->pbupdate->setEnabled( false ) ;
-		m_ui->tableWidget->setEnabled( false ) ;
+		m_ui->tableView->setEnabled( false ) ;
 		m_ui->pbunlockvolume->setEnabled( false ) ;
 		m_ui->pbcreate->setEnabled( false ) ;
 		m_ui->pbFavorites->setEnabled( false ) ;
@@ -1908,8 +1813,8 @@ void sirikali::enableAll()
 
 		m_ui->pbmenu->setEnabled( true ) ;
 		m_ui->pbupdate->setEnabled( true ) ;
-		m_ui->tableWidget->setEnabled( true ) ;
-		m_ui->tableWidget->setFocus() ;
+		m_ui->tableView->setEnabled( true ) ;
+		m_ui->tableView->setFocus() ;
 		m_ui->pbunlockvolume->setEnabled( true ) ;
 		m_ui->pbcreate->setEnabled( true ) ;
 		m_ui->pbFavorites->setEnabled( true ) ;
@@ -1920,7 +1825,7 @@ sirikali::~sirikali()
 {
 	if( m_ui ){
 
-		auto q = m_ui->tableWidget ;
+		auto q = m_ui->tableView ;
 
 		const auto& r = this->window()->geometry() ;
 
@@ -28,6 +28,7 @@
 #include <QVector>
 #include <QSettings>
 #include <QApplication>
+#include <QModelIndex>
 
 #include "volumeinfo.h"
 #include "utility.h"
@@ -41,12 +42,13 @@
 #include "debugwindow.h"
 #include "settings.h"
 #include "systemsignalhandler.h"
+#include "volumeregistry.h"
+#include "favoritesmenu.h"
 
 #include <vector>
 
 class QCloseEvent ;
 class QAction ;
-class QTableWidgetItem ;
 class mountinfo ;
 
 namespace Ui {
@@ -77,10 +79,10 @@ private slots:
 	void unlockVolume( const QStringList& ) ;
 	void closeApplication( int = 0,const QString& = QString() ) ;
 	void unlockVolume( bool ) ;
-	void startGUI( const std::vector< volumeInfo >& ) ;
+	void startGUI( void ) ;
 	void autoMount( const QString& ) ;
 	void defaultButton( void ) ;
-	void itemClicked( QTableWidgetItem * ) ;
+	void itemClicked( const QModelIndex& ) ;
 	void pbUpdate( void ) ;
 	void updateList( void ) ;
 	void createVolume( QAction * = nullptr ) ;
@@ -90,14 +92,10 @@ private slots:
 	void unMountAllAndQuit( void ) ;
 	void pbUmount( void ) ;
 	void slotTrayClicked( QSystemTrayIcon::ActivationReason = QSystemTrayIcon::Trigger ) ;
-	void slotCurrentItemChanged( QTableWidgetItem *,QTableWidgetItem * ) ;
 	void enableAll( void ) ;
 	void slotOpenFolder( void ) ;
 	void slotOpenParentFolder( void ) ;
 	void slotOpenSharedFolder( void ) ;
-	void addEntryToTable( const QStringList& ) ;
-	void addEntryToTable( const volumeInfo& ) ;
-	void removeEntryFromTable( QString ) ;
 	void showFavorites( void ) ;
 	void favoriteClicked( QAction * ) ;
 	void openMountPointPath( const QString& ) ;
@@ -123,15 +121,16 @@ private:
 	void setLocalizationLanguage( bool ) ;
 	void dragEnterEvent( QDragEnterEvent * ) ;
 	void dropEvent( QDropEvent * ) ;
-	void showContextMenu( QTableWidgetItem *,bool ) ;
-	void updateList( const volumeInfo& ) ;
+	void showContextMenu( int row,bool ) ;
+	int currentRow( void ) ;
+	void selectRow( int ) ;
 	void setUpAppMenu( void ) ;
 	void disableAll( void ) ;
 	void closeEvent( QCloseEvent * e ) ;
 	void setUpFont( void ) ;
 	void setUpShortCuts( void ) ;
 	void raiseWindow( const QString& = QString() ) ;
-	void autoUnlockVolumes( const std::vector< volumeInfo >& ) ;	
+	void autoUnlockVolumes( void ) ;
 	favorites::volumeList autoUnlockVolumes( favorites::volumeList,bool = false ) ;
 
 	struct mountedEntry{
@@ -156,6 +155,9 @@ private:
 	QMenu * m_main_menu = nullptr ;
 	QMenu * m_context_menu = nullptr ;
 
+	volumeRegistry m_volumes ;
+	favoritesMenu m_favoritesMenu ;
+
 	QMenu m_language_menu ;
 
 	std::vector< std::pair< QAction *,const char * > > m_actionPair ;
@@ -0,0 +1,84 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SIRIPOLKIT_PROTOCOL_H
+#define SIRIPOLKIT_PROTOCOL_H
+
+#include <QByteArray>
+#include <QtEndian>
+
+/*
+ * SiriKali keeps one connection to siripolkit open for as long as it runs and sends
+ * all of its requests over it.
+ *
+ * Every message is a JSON document preceded by its size as a 4 byte big endian number.
+ * Requests carry an "id" and the response to a request carries the same "id",responses
+ * come back in the order requests finish and not in the order they were sent.
+ */
+class siriPolkitProtocol
+{
+public:
+	enum class status{ complete,incomplete,invalid } ;
+
+	static const int headerSize = 4 ;
+	static const int maxMessageSize = 16 * 1024 * 1024 ;
+
+	static QByteArray message( const QByteArray& e )
+	{
+		char header[ siriPolkitProtocol::headerSize ] ;
+
+		qToBigEndian< quint32 >( static_cast< quint32 >( e.size() ),reinterpret_cast< uchar * >( header ) ) ;
+
+		return QByteArray( header,siriPolkitProtocol::headerSize ) + e ;
+	}
+	/*
+	 * Take the first complete message out of "buffer" and put it in "e".
+	 */
+	static siriPolkitProtocol::status nextMessage( QByteArray& buffer,QByteArray& e )
+	{
+		if( buffer.size() < siriPolkitProtocol::headerSize ){
+
+			return siriPolkitProtocol::status::incomplete ;
+		}
+
+		auto m = reinterpret_cast< const uchar * >( buffer.constData() ) ;
+
+		auto size = qFromBigEndian< quint32 >( m ) ;
+
+		if( size > static_cast< quint32 >( siriPolkitProtocol::maxMessageSize ) ){
+
+			return siriPolkitProtocol::status::invalid ;
+		}
+
+		auto s = static_cast< int >( size ) ;
+
+		if( buffer.size() - siriPolkitProtocol::headerSize < s ){
+
+			return siriPolkitProtocol::status::incomplete ;
+		}
+
+		e = buffer.mid( siriPolkitProtocol::headerSize,s ) ;
+
+		buffer.remove( 0,siriPolkitProtocol::headerSize + s ) ;
+
+		return siriPolkitProtocol::status::complete ;
+	}
+} ;
+
+#endif
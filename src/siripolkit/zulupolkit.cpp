@@ -23,6 +23,7 @@
 #include "task.hpp"
 #include "../utility2.h"
 #include "../json_parser.hpp"
+#include "siripolkitprotocol.h"
 
 #include <termios.h>
 #include <memory>
@@ -31,6 +32,7 @@
 
 #include <QCoreApplication>
 #include <QFile>
+#include <QPointer>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -158,34 +160,52 @@ void zuluPolkit::start()
 	}
 }
 
-static void _respond( QLocalSocket& s,const char * e )
+static void _respond( QLocalSocket * s,qint64 id,const Task::process::result& e )
 {
 	SirikaliJson json( []( const QString& e ){ Q_UNUSED( e ) } ) ;
 
-	json[ "stdOut" ]     = e ;
-	json[ "stdError" ]   = e ;
-	json[ "exitCode" ]   = 255 ;
-	json[ "exitStatus" ] = 255 ;
-	json[ "finished" ]   = true ;
+	json[ "id" ]         = id ;
+	json[ "stdOut" ]     = e.std_out() ;
+	json[ "stdError" ]   = e.std_error() ;
+	json[ "exitCode" ]   = e.exit_code() ;
+	json[ "exitStatus" ] = e.exit_status() ;
+	json[ "finished" ]   = e.finished() ;
 
-	s.write( json.structure() ) ;
+	s->write( siriPolkitProtocol::message( json.structure() ) ) ;
+}
 
-	s.waitForBytesWritten() ;
+static void _respond( QLocalSocket * s,qint64 id,const char * e )
+{
+	_respond( s,id,Task::process::result( e,e,255,255,true ) ) ;
 }
 
-static void _respond( QLocalSocket& s,const Task::process::result& e )
+static void _respond( QLocalSocket * s,qint64 id,const std::vector< Task::process::result >& e )
 {
 	SirikaliJson json( []( const QString& e ){ Q_UNUSED( e ) } ) ;
 
-	json[ "stdOut" ]     = e.std_out() ;
-	json[ "stdError" ]   = e.std_error() ;
-	json[ "exitCode" ]   = e.exit_code() ;
-	json[ "exitStatus" ] = e.exit_status() ;
-	json[ "finished" ]   = e.finished() ;
+	QStringList stdOut ;
+	QStringList stdError ;
+	std::vector< int > exitCodes ;
+	std::vector< int > exitStatuses ;
+	std::vector< bool > finished ;
 
-	s.write( json.structure() ) ;
+	for( const auto& it : e ){
 
-	s.waitForBytesWritten() ;
+		stdOut.append( QString::fromUtf8( it.std_out() ) ) ;
+		stdError.append( QString::fromUtf8( it.std_error() ) ) ;
+		exitCodes.emplace_back( it.exit_code() ) ;
+		exitStatuses.emplace_back( it.exit_status() ) ;
+		finished.emplace_back( it.finished() ) ;
+	}
+
+	json[ "id" ]           = id ;
+	json[ "stdOut" ]       = stdOut ;
+	json[ "stdError" ]     = stdError ;
+	json[ "exitCodes" ]    = exitCodes ;
+	json[ "exitStatuses" ] = exitStatuses ;
+	json[ "finished" ]     = finished ;
+
+	s->write( siriPolkitProtocol::message( json.structure() ) ) ;
 }
 
 bool zuluPolkit::passSanityCheck( const QString& cmd,const QStringList& s )
@@ -206,35 +226,193 @@ bool zuluPolkit::passSanityCheck( const QString& cmd,const QStringList& s )
 
 void zuluPolkit::gotConnection()
 {
-	std::unique_ptr< QLocalSocket > s( m_server.nextPendingConnection() ) ;
+	while( m_server.hasPendingConnections() ){
+
+		auto s = m_server.nextPendingConnection() ;
+
+		m_buffers.insert( s,QByteArray() ) ;
+
+		connect( s,SIGNAL( readyRead() ),this,SLOT( readyRead() ) ) ;
+		connect( s,SIGNAL( disconnected() ),this,SLOT( disconnected() ) ) ;
+	}
+}
+
+void zuluPolkit::readyRead()
+{
+	auto s = qobject_cast< QLocalSocket * >( this->sender() ) ;
+
+	if( s == nullptr || !m_buffers.contains( s ) ){
 
-	auto& m = *s ;
+		return ;
+	}
+
+	auto& buffer = m_buffers[ s ] ;
 
-	m.waitForReadyRead() ;
+	buffer += s->readAll() ;
 
-	auto json = SirikaliJson( m.readAll(),
-				  SirikaliJson::type::CONTENTS,
-				  []( const QString& e ){ Q_UNUSED( e ) } ) ;
+	QByteArray e ;
 
-	auto password = json.getString( "password" ) ;
-	auto cookie   = json.getString( "cookie" ) ;
-	auto command  = json.getString( "command" ) ;
-	auto args     = json.getStringList( "args" ) ;
+	while( true ){
 
-	if( cookie == m_cookie ){
+		auto m = siriPolkitProtocol::nextMessage( buffer,e ) ;
 
-		if( command == "exit" ){
+		if( m == siriPolkitProtocol::status::complete ){
 
-			return QCoreApplication::quit() ;
+			this->processRequest( s,e ) ;
 
-		}else if( this->passSanityCheck( command,args ) ){
+		}else if( m == siriPolkitProtocol::status::incomplete ){
 
-			return _respond( m,Task::process::run( command,args,password.toUtf8() ).get() ) ;
+			break ;
 		}else{
-			_respond( m,"SiriPolkit: Invalid Command" ) ;
+			buffer.clear() ;
+
+			s->disconnectFromServer() ;
+
+			break ;
+		}
+	}
+}
+
+void zuluPolkit::disconnected()
+{
+	auto s = qobject_cast< QLocalSocket * >( this->sender() ) ;
+
+	if( s ){
+
+		m_buffers.remove( s ) ;
+
+		s->deleteLater() ;
+	}
+}
+
+void zuluPolkit::processRequest( QLocalSocket * s,const QByteArray& e )
+{
+	qint64 id = -1 ;
+
+	QString password ;
+	QString cookie ;
+	QString command ;
+	QStringList args ;
+	QStringList passwords ;
+	QString exe ;
+
+	try{
+		auto json = SirikaliJson( e,
+					  SirikaliJson::type::CONTENTS,
+					  []( const QString& e ){ Q_UNUSED( e ) } ) ;
+
+		id       = json.get< qint64 >( "id",-1 ) ;
+		password = json.getString( "password" ) ;
+		cookie   = json.getString( "cookie" ) ;
+		command  = json.getString( "command" ) ;
+		args     = json.getStringList( "args" ) ;
+
+		if( command == "batch" ){
+
+			exe       = json.getString( "exe" ) ;
+			passwords = json.getStringList( "passwords" ) ;
 		}
+
+	}catch( ... ){
+
+		return _respond( s,id,"SiriPolkit: Invalid Request" ) ;
+	}
+
+	if( cookie != m_cookie ){
+
+		return _respond( s,id,"SiriPolkit: Failed To Authenticate Request" ) ;
+	}
+
+	if( command == "exit" ){
+
+		return QCoreApplication::quit() ;
+
+	}else if( command == "batch" ){
+
+		this->processBatch( s,id,exe,args,passwords ) ;
+
+	}else if( this->passSanityCheck( command,args ) ){
+
+		/*
+		 * Commands run concurrently,a response goes out as soon as its command
+		 * is done.
+		 */
+		QPointer< QLocalSocket > socket( s ) ;
+
+		Task::process::run( command,args,password.toUtf8() ).then( [ socket,id ]( const Task::process::result& e ){
+
+			if( socket ){
+
+				_respond( socket.data(),id,e ) ;
+			}
+		} ) ;
 	}else{
-		_respond( m,"SiriPolkit: Failed To Authenticate Request" ) ;
+		_respond( s,id,"SiriPolkit: Invalid Command" ) ;
+	}
+}
+
+/*
+ * A batch is a list of commands for "su - -c" with a matching list of passwords,"exe"
+ * is the path to "su".Every command is checked on its own,all of them run at the same
+ * time and a single response carries all of their results in the order they were sent.
+ */
+void zuluPolkit::processBatch( QLocalSocket * s,
+			       qint64 id,
+			       const QString& exe,
+			       const QStringList& commands,
+			       const QStringList& passwords )
+{
+	struct batch{
+
+		batch( int size ) : results( static_cast< size_t >( size ) ),remaining( size )
+		{
+		}
+		std::vector< Task::process::result > results ;
+		int remaining ;
+	} ;
+
+	auto m = std::make_shared< batch >( commands.size() ) ;
+
+	QPointer< QLocalSocket > socket( s ) ;
+
+	auto _done = [ m,socket,id ](){
+
+		m->remaining-- ;
+
+		if( m->remaining == 0 && socket ){
+
+			_respond( socket.data(),id,m->results ) ;
+		}
+	} ;
+
+	if( commands.isEmpty() ){
+
+		return _respond( s,id,m->results ) ;
+	}
+
+	for( int i = 0 ; i < commands.size() ; i++ ){
+
+		auto& r = m->results[ static_cast< size_t >( i ) ] ;
+
+		QStringList args{ "-","-c",commands.at( i ) } ;
+
+		if( this->passSanityCheck( exe,args ) ){
+
+			auto password = i < passwords.size() ? passwords.at( i ).toUtf8() : QByteArray() ;
+
+			Task::process::run( exe,args,password ).then( [ &r,_done ]( const Task::process::result& e ){
+
+				r = e ;
+
+				_done() ;
+			} ) ;
+		}else{
+			auto e = "SiriPolkit: Invalid Command" ;
+
+			r = Task::process::result( e,e,255,255,true ) ;
+
+			_done() ;
+		}
 	}
 }
 
@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
+#include <QByteArray>
+#include <QHash>
 #include <QtNetwork/QLocalServer>
 #include <QtNetwork/QLocalSocket>
 
@@ -35,8 +37,13 @@ public:
 private slots:
 	void start() ;
 	void gotConnection() ;
+	void readyRead() ;
+	void disconnected() ;
 private:
+	void processRequest( QLocalSocket *,const QByteArray& ) ;
+	void processBatch( QLocalSocket *,qint64 id,const QString& exe,const QStringList&,const QStringList& ) ;
 	bool passSanityCheck( const QString& cmd,const QStringList& s ) ;
+	QHash< QLocalSocket *,QByteArray > m_buffers ;
 	QStringList m_arguments ;
 	QString readStdin() ;
 	QString m_cookie ;
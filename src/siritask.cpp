@@ -23,11 +23,19 @@
 #include "win.h"
 #include "settings.h"
 #include "sirikali.h"
+#include "processlauncher.h"
 
 #include <QDir>
 #include <QString>
 #include <QDebug>
 #include <QFile>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 static bool _create_folder( const QString& m )
 {
@@ -124,7 +132,7 @@ static void _run_command( const engines::engine::exe& exe,
 
 		e.insert( settings::instance().environmentalVariableVolumeKey(),password ) ;
 
-		utility::unwrap( Task::run( [ & ](){ utility::Task( exe.exe,exe.args,e,[](){} ) ; } ) ) ;
+		utility::unwrap( Task::run_io( [ & ](){ utility::Task( exe.exe,exe.args,e,nullptr ) ; } ) ) ;
 	}
 }
 
@@ -204,13 +212,18 @@ static engines::engine::cmdStatus _unmount( const engines::engine::unMount& e )
 			return { engines::engine::status::failedToStartPolkit,engine } ;
 		}
 
-		auto s = utility::unwrap( Task::run( [ & ](){
+		auto s = utility::unwrap( Task::run_io( [ & ](){
 
 			_run_preUnmountCommand( e ) ;
 
 			return engine.unmount( e ) ;
 		} ) ) ;
 
+		if( s == engines::engine::status::success ){
+
+			mountinfo::volumesChanged() ;
+		}
+
 		return { s,engine } ;
 	}
 }
@@ -241,6 +254,304 @@ engines::engine::cmdStatus siritask::encryptedFolderUnMount( const siritask::unm
 	}
 }
 
+std::vector< engines::engine::cmdStatus > siritask::encryptedFolderUnMount( const std::vector< siritask::unmount >& e )
+{
+	std::vector< engines::engine::cmdStatus > s( e.size() ) ;
+
+	if( utility::platformIsWindows() || e.size() < 2 ){
+
+		for( size_t i = 0 ; i < e.size() ; i++ ){
+
+			s[ i ] = siritask::encryptedFolderUnMount( e[ i ] ) ;
+		}
+
+		return s ;
+	}
+
+	/*
+	 * Group volumes by their engine,keeping the order in which engines first show up.
+	 */
+	std::vector< std::pair< QString,std::vector< size_t > > > groups ;
+
+	for( size_t i = 0 ; i < e.size() ; i++ ){
+
+		auto it = std::find_if( groups.begin(),groups.end(),[ & ]( const std::pair< QString,std::vector< size_t > >& m ){
+
+			return m.first == e[ i ].fileSystem ;
+		} ) ;
+
+		if( it == groups.end() ){
+
+			groups.emplace_back( e[ i ].fileSystem,std::vector< size_t >{ i } ) ;
+		}else{
+			it->second.emplace_back( i ) ;
+		}
+	}
+
+	for( const auto& group : groups ){
+
+		const auto& engine = engines::instance().getByName( group.first ) ;
+
+		const auto& indexes = group.second ;
+
+		if( engine.unknown() || indexes.size() < 2 ){
+
+			for( auto it : indexes ){
+
+				s[ it ] = siritask::encryptedFolderUnMount( e[ it ] ) ;
+			}
+
+			continue ;
+		}
+
+		if( engine.requiresPolkit() && !utility::enablePolkit() ){
+
+			for( auto it : indexes ){
+
+				s[ it ] = { engines::engine::status::failedToStartPolkit,engine } ;
+			}
+
+			continue ;
+		}
+
+		std::vector< favorites::entry > favs ;
+		std::vector< bool > hasFav ;
+		std::vector< engines::engine::unMount > volumes ;
+
+		for( auto it : indexes ){
+
+			const auto& m = e[ it ] ;
+
+			auto fav = favorites::instance().readFavorite( m.cipherFolder,m.mountPoint ) ;
+
+			hasFav.emplace_back( fav.has_value() ) ;
+
+			if( fav.has_value() ){
+
+				favs.emplace_back( fav.value() ) ;
+
+				const auto& f = favs.back() ;
+
+				_run_command( { f.preUnmountCommand,m.cipherFolder,m.mountPoint,m.fileSystem,"pre unmount",QByteArray() } ) ;
+			}else{
+				favs.emplace_back() ;
+			}
+
+			volumes.push_back( { m.cipherFolder,m.mountPoint,m.fileSystem,m.numberOfAttempts } ) ;
+		}
+
+		auto r = utility::unwrap( Task::run_io( [ & ](){
+
+			for( const auto& it : volumes ){
+
+				_run_preUnmountCommand( it ) ;
+			}
+
+			return engine.unmountVolumes( volumes ) ;
+		} ) ) ;
+
+		bool changed = false ;
+
+		for( size_t i = 0 ; i < indexes.size() ; i++ ){
+
+			const auto& m = e[ indexes[ i ] ] ;
+
+			auto status = i < r.size() ? r[ i ] : engines::engine::status::failedToUnMount ;
+
+			s[ indexes[ i ] ] = { status,engine } ;
+
+			if( status == engines::engine::status::success ){
+
+				changed = true ;
+
+				if( hasFav[ i ] ){
+
+					const auto& f = favs[ i ] ;
+
+					_run_command( { f.postUnmountCommand,m.cipherFolder,m.mountPoint,m.fileSystem,"post unmount",QByteArray() } ) ;
+				}
+			}
+		}
+
+		if( changed ){
+
+			mountinfo::volumesChanged() ;
+		}
+	}
+
+	return s ;
+}
+
+/*
+ * Call "function" with every index in "indexes" at the same time and wait at most
+ * "milliseconds" for them to finish.Calls that are still running when time runs out
+ * are left behind and they must not touch anything they do not own.
+ */
+template< typename Function >
+static std::vector< bool > _run_concurrently( const std::vector< size_t >& indexes,qint64 milliseconds,Function function )
+{
+	struct state{
+
+		std::mutex mutex ;
+		std::condition_variable cv ;
+		std::vector< bool > succeeded ;
+		size_t remaining ;
+	} ;
+
+	auto s = std::make_shared< state >() ;
+
+	s->succeeded.resize( indexes.size(),false ) ;
+	s->remaining = indexes.size() ;
+
+	for( size_t i = 0 ; i < indexes.size() ; i++ ){
+
+		auto index = indexes[ i ] ;
+
+		Task::run_io( [ s,i,index,function ](){
+
+			auto m = function( index ) ;
+
+			std::lock_guard< std::mutex > lock( s->mutex ) ;
+
+			s->succeeded[ i ] = m ;
+			s->remaining-- ;
+
+			s->cv.notify_all() ;
+		} ).start() ;
+	}
+
+	std::unique_lock< std::mutex > lock( s->mutex ) ;
+
+	s->cv.wait_for( lock,std::chrono::milliseconds( qMax( milliseconds,qint64( 0 ) ) ),[ & ](){
+
+		return s->remaining == 0 ;
+	} ) ;
+
+	return s->succeeded ;
+}
+
+std::vector< size_t > siritask::emergencyUnMount( const std::vector< siritask::unmount >& e,int milliseconds )
+{
+	QElapsedTimer timer ;
+
+	timer.start() ;
+
+	/*
+	 * The last quarter of the time is kept for lazy unmounts.
+	 */
+	qint64 lazyAt = milliseconds - milliseconds / 4 ;
+
+	struct volume{
+
+		QString cipherFolder ;
+		QString mountPoint ;
+		QString fileSystem ;
+	} ;
+
+	auto volumes = std::make_shared< std::vector< volume > >() ;
+
+	std::vector< size_t > indexes ;
+
+	for( size_t i = 0 ; i < e.size() ; i++ ){
+
+		volumes->push_back( { e[ i ].cipherFolder,e[ i ].mountPoint,e[ i ].fileSystem } ) ;
+		indexes.emplace_back( i ) ;
+	}
+
+	bool removeFolders = !settings::instance().reUseMountPoint() ;
+
+	/*
+	 * No pre or post unmount commands and no favorites lookups.A volume that is busy
+	 * because another volume is mounted inside it is tried again until it is its
+	 * turn or the time for normal unmounts is up.
+	 */
+	auto s = _run_concurrently( indexes,lazyAt,[ = ]( size_t i ){
+
+		const auto& m = ( *volumes )[ i ] ;
+
+		const auto& engine = engines::instance().getByName( m.fileSystem ) ;
+
+		if( engine.unknown() ){
+
+			return false ;
+		}
+
+		engines::engine::unMount u{ m.cipherFolder,m.mountPoint,m.fileSystem,1 } ;
+
+		while( true ){
+
+			if( engine.unmount( u ) == engines::engine::status::success ){
+
+				if( removeFolders && engine.backendRequireMountPath() ){
+
+					utility::removeFolder( m.mountPoint ) ;
+				}
+
+				return true ;
+			}
+
+			if( timer.elapsed() + 250 >= lazyAt ){
+
+				return false ;
+			}
+
+			std::this_thread::sleep_for( std::chrono::milliseconds( 250 ) ) ;
+		}
+	} ) ;
+
+	indexes.clear() ;
+
+	for( size_t i = 0 ; i < s.size() ; i++ ){
+
+		if( !s[ i ] ){
+
+			indexes.emplace_back( i ) ;
+		}
+	}
+
+	if( indexes.empty() ){
+
+		return indexes ;
+	}
+
+	auto remaining = milliseconds - timer.elapsed() ;
+
+	auto m = _run_concurrently( indexes,remaining,[ = ]( size_t i ){
+
+		const auto& m = ( *volumes )[ i ] ;
+
+		const auto& engine = engines::instance().getByName( m.fileSystem ) ;
+
+		auto timeOut = static_cast< int >( qMax( remaining,qint64( 1 ) ) ) ;
+
+		if( utility::platformIsOSX() ){
+
+			return processLauncher::run( "umount",{ "-f",m.mountPoint },timeOut ).success() ;
+
+		}else if( engine.known() && engine.unMountCommand().isEmpty() ){
+
+			/*
+			 * Backends we unmount with "fusermount -u" are FUSE file systems.
+			 */
+			return processLauncher::run( "fusermount",{ "-uz",m.mountPoint },timeOut ).success() ;
+		}else{
+			return processLauncher::run( "umount",{ "-l",m.mountPoint },timeOut ).success() ;
+		}
+	} ) ;
+
+	std::vector< size_t > left ;
+
+	for( size_t i = 0 ; i < m.size() ; i++ ){
+
+		if( !m[ i ] ){
+
+			left.emplace_back( indexes[ i ] ) ;
+		}
+	}
+
+	return left ;
+}
+
 struct cmd_args{
 
 	const engines::engine& engine ;
@@ -263,11 +574,76 @@ struct run_task{
 	bool create ;
 };
 
+/*
+ * Look at the output of a backend as it arrives and decide if the outcome is already
+ * known,this saves us from waiting for backends that take their time to exit after
+ * they reject a password.
+ */
+static processLauncher::action _backend_status( const engines::engine& engine,
+						const QByteArray& std_out,
+						const QByteArray& std_error )
+{
+	auto e = QString::fromUtf8( std_error + std_out ) ;
+
+	const auto& m = engine.incorrectPasswordText() ;
+
+	if( !m.isEmpty() && e.contains( m ) ){
+
+		return processLauncher::action::failed ;
+	}
+
+	auto s = engine.errorCode( e ) ;
+
+	if( s == engines::engine::error::Failed ){
+
+		return processLauncher::action::failed ;
+
+	}else if( s == engines::engine::error::Success ){
+
+		/*
+		 * We still wait for the backend to exit since it only does so after the
+		 * volume is mounted.
+		 */
+		return processLauncher::action::succeeded ;
+	}else{
+		return processLauncher::action::proceed ;
+	}
+}
+
 static utility::Task _run_task_0( const run_task& e )
 {
 	if( utility::platformIsWindows() ){
 
 		return SiriKali::Windows::run( { e.create,e.args,e.opts,e.engine,e.password } ) ;
+
+	}else if( !e.engine.requiresPolkit() && e.engine.backendRunsInBackGround() ){
+
+		QElapsedTimer timer ;
+
+		timer.start() ;
+
+		auto s = processLauncher::run( e.args.cmd,
+					       e.args.cmd_args,
+					       -1,
+					       e.password,
+					       e.engine.getProcessEnvironment(),
+					       [ & ]( const QByteArray& std_out,const QByteArray& std_error ){
+
+			auto m = _backend_status( e.engine,std_out,std_error ) ;
+
+			if( m == processLauncher::action::failed ){
+
+				auto a = QString::number( timer.elapsed() ) ;
+
+				utility::debug() << "Backend reported a failure after " + a + " milliseconds" ;
+			}
+
+			return m ;
+		} ) ;
+
+		utility::logCommandOutPut( s,e.args.cmd,e.args.cmd_args ) ;
+
+		return s ;
 	}else{
 		const auto& s = e.engine.getProcessEnvironment() ;
 
@@ -276,7 +652,7 @@ static utility::Task _run_task_0( const run_task& e )
 				      -1,
 				      s,
 				      e.password,
-				      [](){},
+				      nullptr,
 				      e.engine.requiresPolkit(),
 				      e.engine.backendRunsInBackGround() ) ;
 	}
@@ -322,14 +698,8 @@ struct build_config_path{
 	const QString& configFilePath ;
 };
 
-static engines::engine::cmdStatus _cmd( const cmd_args& e )
+static engines::engine::cmdStatus _cmd_status( const engines::engine& engine,const utility::Task& s )
 {
-	const auto& engine = e.engine ;
-
-	auto cmd = engine.command( e.password,e.opts,e.create ) ;
-
-	auto s = _run_task( { cmd,e } ) ;
-
 	if( s.success() ){
 
 		return { engines::engine::status::success,engine } ;
@@ -350,46 +720,149 @@ static engines::engine::cmdStatus _cmd( const cmd_args& e )
 	}
 }
 
-static engines::engine::cmdStatus _mount( const siritask::mount& s )
+static engines::engine::cmdStatus _cmd( const cmd_args& e )
+{
+	auto cmd = e.engine.command( e.password,e.opts,e.create ) ;
+
+	return _cmd_status( e.engine,_run_task( { cmd,e } ) ) ;
+}
+
+/*
+ * A backend that runs in the background exits once it has daemonized,its volume may
+ * show up in the mount table a little later.Wait for it to avoid showing a volume list
+ * that does not have it yet.
+ */
+static void _wait_for_volume( const engines::engine& engine,
+			      const engines::engine::cmdArgsList& opt,
+			      const QElapsedTimer& timer )
 {
-	const auto& Engine = s.engine ;
-	const auto& engine = Engine.get() ;
+	if( utility::platformIsWindows() ){
 
-	auto opt = s.options ;
+		return ;
+	}
 
-	opt.configFilePath = Engine.configFilePath() ;
-	opt.cipherFolder   = Engine.cipherFolder() ;
+	if( !engine.backendRunsInBackGround() || !engine.autorefreshOnMountUnMount() ){
 
-	engine.updateOptions( opt,false ) ;
+		return ;
+	}
 
-	auto mm = engine.passAllRequirenments( opt ) ;
+	auto timeOut = settings::instance().mountReadyTimeOut() ;
+
+	if( timeOut <= 0 ){
+
+		return ;
+	}
+
+	auto a = QString::number( timer.elapsed() ) ;
+
+	if( mountinfo::waitForVolume( opt.cipherFolder,opt.mountPoint,timeOut ) ){
+
+		auto b = QString::number( timer.elapsed() ) ;
+
+		utility::debug() << QString( "Volume ready after %1 ms(backend exited after %2 ms)" ).arg( b,a ) ;
+	}else{
+		auto b = QString::number( timeOut ) ;
+
+		utility::debug() << QString( "Volume did not show up in the mount table within %1 ms" ).arg( b ) ;
+	}
+}
+
+siritask::mountStages::mountStages( const siritask::mount& e ) :
+	m_engine( e.engine ),
+	m_options( e.options ),
+	m_opt( e.options ),
+	m_reUseMP( e.reUseMP )
+{
+}
+
+bool siritask::mountStages::prepare()
+{
+	QElapsedTimer timer ;
+
+	timer.start() ;
+
+	const auto& engine = m_engine.get() ;
+
+	m_opt.configFilePath = m_engine.configFilePath() ;
+	m_opt.cipherFolder   = m_engine.cipherFolder() ;
+
+	engine.updateOptions( m_opt,false ) ;
+
+	auto mm = engine.passAllRequirenments( m_opt ) ;
 
 	if( mm != engines::engine::status::success ){
 
-		return { mm,engine } ;
+		m_status = { mm,engine } ;
+		m_prepareTime = timer.elapsed() ;
+
+		return false ;
 	}
 
 	if( engine.backendRequireMountPath() ){
 
-		if( !( _create_folder( opt.mountPoint ) || s.reUseMP ) ){
+		if( !( _create_folder( m_opt.mountPoint ) || m_reUseMP ) ){
 
-			return { engines::engine::status::failedToCreateMountPoint,engine } ;
+			m_status = { engines::engine::status::failedToCreateMountPoint,engine } ;
+			m_prepareTime = timer.elapsed() ;
+
+			return false ;
+		}
+	}
+
+	m_cmd = engine.command( m_opt.key,m_opt,false ) ;
+
+	m_favorite = favorites::instance().readFavorite( m_opt.cipherFolder,m_opt.mountPoint ) ;
+
+	if( m_favorite.has_value() ){
+
+		if( settings::instance().allowExternalToolsToReadPasswords() ){
+
+			m_externalToolKey = m_opt.key ;
 		}
+
+		const auto& m = m_favorite.value() ;
+
+		const auto& a = m_opt.cipherFolder ;
+		const auto& b = m_opt.mountPoint ;
+		const auto& c = engine.name() ;
+
+		_run_command( { m.preMountCommand,a,b,c,"pre mount",m_externalToolKey } ) ;
 	}
 
-	auto e = _cmd( { engine,false,opt,opt.key } ) ;
+	m_prepareTime = timer.elapsed() ;
+
+	return true ;
+}
+
+bool siritask::mountStages::spawn()
+{
+	QElapsedTimer timer ;
 
-	if( e != engines::engine::status::success ){
+	timer.start() ;
+
+	const auto& engine = m_engine.get() ;
+
+	m_status = _cmd_status( engine,_run_task_0( { m_cmd,{ engine,false,m_opt,m_opt.key } } ) ) ;
+
+	if( m_status != engines::engine::status::success ){
 
 		if( engine.backendRequireMountPath() ){
 
-			siritask::deleteMountFolder( opt.mountPoint ) ;
+			siritask::deleteMountFolder( m_opt.mountPoint ) ;
 		}
-	}else{
-		engine.updateVolumeList( opt ) ;
+
+		m_spawnTime = timer.elapsed() ;
+
+		return false ;
 	}
 
-	return e ;
+	engine.updateVolumeList( m_opt ) ;
+
+	_wait_for_volume( engine,m_opt,timer ) ;
+
+	m_spawnTime = timer.elapsed() ;
+
+	return true ;
 }
 
 static engines::engine::cmdStatus _create( const siritask::create& s )
@@ -479,7 +952,7 @@ engines::engine::cmdStatus siritask::encryptedFolderCreate( const siritask::crea
 			return _create( e ) ;
 		}
 	}else{
-		auto& s = Task::run( [ & ](){ return _create( e ) ; } ) ;
+		auto& s = Task::run_io( [ & ](){ return _create( e ) ; } ) ;
 
 		return utility::unwrap( s ) ;
 	}
@@ -496,7 +969,7 @@ static void _run_command_on_mount( const siritask::mount& e )
 
 		QStringList opts = { opt.cipherFolder,opt.mountPoint,type } ;
 
-		Task::exec( [ = ](){
+		Task::run_io( [ = ](){
 
 			auto r = [ & ](){
 
@@ -507,16 +980,16 @@ static void _run_command_on_mount( const siritask::mount& e )
 
 					e.insert( m.environmentalVariableVolumeKey(),opt.key ) ;
 
-					return Task::process::run( s,opts,-1,{},e ).get() ;
+					return processLauncher::run( s,opts,-1,{},e ) ;
 				}else{
 					const auto& e = utility::systemEnvironment() ;
 
-					return Task::process::run( s,opts,-1,{},e ).get() ;
+					return processLauncher::run( s,opts,-1,{},e ) ;
 				}
 			}() ;
 
 			utility::logCommandOutPut( r,s,opts ) ;
-		} ) ;
+		} ).start() ;
 	}
 }
 
@@ -525,36 +998,57 @@ engines::engine::cmdStatus siritask::encryptedFolderMount( const engines::engine
 	return siritask::encryptedFolderMount( { s,false,{ s.cipherFolder,s.configFilePath } } ) ;
 }
 
-engines::engine::cmdStatus siritask::encryptedFolderMount( const siritask::mount& e )
+void siritask::mountStages::finish()
 {
-	auto s = [ & ](){
+	QElapsedTimer timer ;
 
-		if( utility::platformIsWindows() ){
+	timer.start() ;
 
-			if( utility::runningOnGUIThread() ){
+	if( m_favorite.has_value() ){
 
-				return _mount( e ) ;
-			}else{
-				/*
-				 * We should not take this path
-				 */
-				_warning( "siritask::encryptedFolderMount" ) ;
-				return _mount( e ) ;
-			}
-		}else{
-			auto& s = Task::run( [ & ](){
+		const auto& m = m_favorite.value() ;
+
+		const auto& a = m_opt.cipherFolder ;
+		const auto& b = m_opt.mountPoint ;
+		const auto& c = m_engine->name() ;
+
+		_run_command( { m.postMountCommand,a,b,c,"post mount",m_externalToolKey } ) ;
+	}
+
+	mountinfo::volumesChanged() ;
 
-				return _mount( e ) ;
-			} ) ;
+	_run_command_on_mount( { m_options,m_reUseMP,m_engine } ) ;
 
-			return utility::unwrap( s ) ;
+	m_finishTime = timer.elapsed() ;
+}
+
+engines::engine::cmdStatus siritask::encryptedFolderMount( const siritask::mount& e )
+{
+	siritask::mountStages s( e ) ;
+
+	auto _mount = [ & ](){
+
+		if( s.prepare() && s.spawn() ){
+
+			s.finish() ;
 		}
-	}() ;
+	} ;
+
+	if( utility::platformIsWindows() ){
 
-	if( s == engines::engine::status::success ){
+		if( utility::runningOnGUIThread() ){
 
-		_run_command_on_mount( e ) ;
+			_mount() ;
+		}else{
+			/*
+			 * We should not take this path
+			 */
+			_warning( "siritask::encryptedFolderMount" ) ;
+			_mount() ;
+		}
+	}else{
+		utility::unwrap( Task::run_io( _mount ) ) ;
 	}
 
-	return s ;
+	return s.status() ;
 }
@@ -58,8 +58,76 @@ namespace siritask
 
 	engines::engine::cmdStatus encryptedFolderUnMount( const siritask::unmount& ) ;
 
+	/*
+	 * Volumes of an engine that can unmount many volumes at once are unmounted
+	 * together,statuses come back in the same order as the volumes.
+	 */
+	std::vector< engines::engine::cmdStatus > encryptedFolderUnMount( const std::vector< siritask::unmount >& ) ;
+
+	/*
+	 * Unmount volumes when there is no time to do it properly,all of them at once,with
+	 * no pre or post unmount commands and no retries past the deadline.Volumes still
+	 * mounted when three quarters of "milliseconds" are gone are lazily unmounted.
+	 *
+	 * Returns indexes of volumes that could not be unmounted.Not for use on Windows.
+	 */
+	std::vector< size_t > emergencyUnMount( const std::vector< siritask::unmount >&,int milliseconds ) ;
+
 	engines::engine::cmdStatus encryptedFolderMount( const siritask::mount& ) ;
 
+	/*
+	 * The steps of mounting a volume,encryptedFolderMount() runs them back to back.
+	 *
+	 * prepare() checks the backend's requirements,creates the mount point folder,
+	 * builds the backend's command line and runs the favorite's pre mount command.
+	 * spawn() runs the backend and waits for the volume to show up in the mount table.
+	 * finish() runs the post mount command and the command to run on every mount.
+	 *
+	 * prepare() and spawn() return false and set status() when the volume can not be
+	 * mounted,the next step must not be called after that.Each step can run on any
+	 * thread but only one step can run at a time.
+	 */
+	class mountStages
+	{
+	public:
+		mountStages( const siritask::mount& ) ;
+		bool prepare() ;
+		bool spawn() ;
+		void finish() ;
+		const engines::engine::cmdStatus& status() const
+		{
+			return m_status ;
+		}
+		const engines::engine::cmdArgsList& options() const
+		{
+			return m_options ;
+		}
+		qint64 prepareTime() const
+		{
+			return m_prepareTime ;
+		}
+		qint64 spawnTime() const
+		{
+			return m_spawnTime ;
+		}
+		qint64 finishTime() const
+		{
+			return m_finishTime ;
+		}
+	private:
+		engines::engineWithPaths m_engine ;
+		engines::engine::cmdArgsList m_options ;
+		engines::engine::cmdArgsList m_opt ;
+		bool m_reUseMP ;
+		utility2::result< favorites::entry > m_favorite ;
+		QByteArray m_externalToolKey ;
+		engines::engine::args m_cmd ;
+		engines::engine::cmdStatus m_status ;
+		qint64 m_prepareTime = 0 ;
+		qint64 m_spawnTime = 0 ;
+		qint64 m_finishTime = 0 ;
+	} ;
+
 	engines::engine::cmdStatus encryptedFolderMount( const engines::engine::cmdArgsList& s ) ;
 
 	engines::engine::cmdStatus encryptedFolderCreate( const siritask::create& ) ;
@@ -0,0 +1,262 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "unmountscheduler.h"
+#include "siritask.h"
+#include "mountinfo.h"
+#include "settings.h"
+#include "utility.h"
+
+static bool _is_under( const QString& path,const QString& mountPoint )
+{
+	return path.startsWith( mountPoint + "/" ) ;
+}
+
+/*
+ * "b" has to be unmounted before "a" can be.
+ */
+static bool _depends_on( const unmountScheduler::volume& a,const unmountScheduler::volume& b )
+{
+	return _is_under( b.mountPoint,a.mountPoint ) || _is_under( b.cipherPath,a.mountPoint ) ;
+}
+
+static bool _requires_polkit( const unmountScheduler::volume& e )
+{
+	if( utility::platformIsWindows() ){
+
+		return false ;
+	}
+
+	const auto& engine = engines::instance().getByName( e.fileSystem ) ;
+
+	return engine.known() && engine.requiresPolkit() ;
+}
+
+static std::vector< engines::engine::cmdStatus > _unmount( const std::vector< unmountScheduler::volume >& e,int timeOut )
+{
+	std::vector< siritask::unmount > volumes ;
+
+	for( const auto& it : e ){
+
+		volumes.push_back( { it.cipherPath,it.mountPoint,it.fileSystem,5 } ) ;
+	}
+
+	auto s = siritask::encryptedFolderUnMount( volumes ) ;
+
+	for( size_t i = 0 ; i < s.size() ; i++ ){
+
+		if( s[ i ].success() ){
+
+			const auto& m = e[ i ].mountPoint ;
+
+			if( !utility::platformIsWindows() ){
+
+				/*
+				 * Volumes this one sits in must not be attempted before it is
+				 * out of the mount table.
+				 */
+				mountinfo::waitForVolumeRemoval( m,timeOut ) ;
+			}
+
+			if( s[ i ].engine().backendRequireMountPath() ){
+
+				siritask::deleteMountFolder( m ) ;
+			}
+		}
+	}
+
+	return s ;
+}
+
+unmountScheduler::unmountScheduler( std::vector< unmountScheduler::volume > e,int concurrency ) :
+	m_concurrency( utility::platformIsWindows() ? 1 : qMax( concurrency,1 ) ),
+	m_timeOut( qMax( settings::instance().unMountRemovalTimeOut(),1000 ) )
+{
+	m_nodes.reserve( e.size() ) ;
+
+	for( auto& it : e ){
+
+		m_nodes.emplace_back( std::move( it ) ) ;
+	}
+
+	for( size_t i = 0 ; i < m_nodes.size() ; i++ ){
+
+		for( size_t j = 0 ; j < m_nodes.size() ; j++ ){
+
+			if( i != j && _depends_on( m_nodes[ i ].volume,m_nodes[ j ].volume ) ){
+
+				m_nodes[ i ].blockers++ ;
+				m_nodes[ j ].dependents.emplace_back( i ) ;
+			}
+		}
+	}
+
+	for( size_t i = 0 ; i < m_nodes.size() ; i++ ){
+
+		if( m_nodes[ i ].blockers == 0 ){
+
+			m_ready.emplace_back( i ) ;
+		}
+	}
+}
+
+int unmountScheduler::run( unmountScheduler::function function )
+{
+	m_function = std::move( function ) ;
+
+	for( const auto& it : m_nodes ){
+
+		if( _requires_polkit( it.volume ) ){
+
+			/*
+			 * Start siripolkit here and not from jobs that may race each other
+			 * doing it.
+			 */
+			utility::enablePolkit() ;
+
+			break ;
+		}
+	}
+
+	this->start() ;
+
+	if( m_running > 0 ){
+
+		m_loop.exec() ;
+	}
+
+	return m_failed ;
+}
+
+std::vector< size_t > unmountScheduler::nextJob()
+{
+	std::vector< size_t > s{ m_ready.front() } ;
+
+	m_ready.erase( m_ready.begin() ) ;
+
+	if( _requires_polkit( m_nodes[ s.front() ].volume ) ){
+
+		auto it = m_ready.begin() ;
+
+		while( it != m_ready.end() ){
+
+			if( _requires_polkit( m_nodes[ *it ].volume ) ){
+
+				s.emplace_back( *it ) ;
+
+				it = m_ready.erase( it ) ;
+			}else{
+				it++ ;
+			}
+		}
+	}
+
+	return s ;
+}
+
+void unmountScheduler::start()
+{
+	while( m_running < m_concurrency && !m_ready.empty() ){
+
+		auto indexes = this->nextJob() ;
+
+		std::vector< unmountScheduler::volume > volumes ;
+
+		for( const auto& it : indexes ){
+
+			volumes.emplace_back( m_nodes[ it ].volume ) ;
+		}
+
+		if( utility::platformIsWindows() ){
+
+			/*
+			 * Windows volumes are tracked by objects that belong to this thread.
+			 */
+			this->finished( indexes,_unmount( volumes,m_timeOut ) ) ;
+		}else{
+			m_running++ ;
+
+			auto timeOut = m_timeOut ;
+
+			/*
+			 * Jobs spend their time waiting on processes and on the mount table.
+			 */
+			Task::run_io( [ volumes,timeOut ](){
+
+				return _unmount( volumes,timeOut ) ;
+
+			} ).then( [ this,indexes ]( const std::vector< engines::engine::cmdStatus >& s ){
+
+				m_running-- ;
+
+				this->finished( indexes,s ) ;
+
+				this->start() ;
+			} ) ;
+		}
+	}
+
+	if( m_running == 0 && m_ready.empty() ){
+
+		/*
+		 * Whatever is left waits on a volume that did not go away.
+		 */
+		for( auto& it : m_nodes ){
+
+			if( !it.done ){
+
+				it.done = true ;
+
+				m_failed++ ;
+
+				m_function( { it.volume,it.status,true } ) ;
+			}
+		}
+
+		m_loop.quit() ;
+	}
+}
+
+void unmountScheduler::finished( const std::vector< size_t >& indexes,
+				 const std::vector< engines::engine::cmdStatus >& s )
+{
+	for( size_t i = 0 ; i < indexes.size() ; i++ ){
+
+		auto& node = m_nodes[ indexes[ i ] ] ;
+
+		node.status = s[ i ] ;
+		node.done   = true ;
+
+		m_function( { node.volume,node.status,false } ) ;
+
+		if( node.status.success() ){
+
+			for( const auto& it : node.dependents ){
+
+				if( --m_nodes[ it ].blockers == 0 ){
+
+					m_ready.emplace_back( it ) ;
+				}
+			}
+		}else{
+			m_failed++ ;
+		}
+	}
+}
@@ -0,0 +1,107 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UNMOUNT_SCHEDULER_H
+#define UNMOUNT_SCHEDULER_H
+
+#include <QString>
+#include <QEventLoop>
+
+#include <vector>
+#include <functional>
+
+#include "engines.h"
+
+/*
+ * Unmounts a list of volumes as fast as their nesting allows.
+ *
+ * A volume is unmounted only after every volume mounted under its mount point,or
+ * whose cipher folder is under its mount point,is gone from the mount table.Volumes
+ * that do not depend on each other are unmounted concurrently,with at most "concurrency"
+ * jobs running at a time.Ready volumes of engines that go through siripolkit share a
+ * job and are sent to it in one request.
+ *
+ * A volume is not attempted if something under it failed to unmount.
+ */
+class unmountScheduler
+{
+public:
+	struct volume{
+
+		QString cipherPath ;
+		QString mountPoint ;
+		QString fileSystem ;
+	} ;
+
+	struct result{
+
+		const unmountScheduler::volume& volume ;
+		const engines::engine::cmdStatus& status ;
+		/*
+		 * true if the volume was not attempted because a volume under it could
+		 * not be unmounted.
+		 */
+		bool blocked ;
+	} ;
+
+	using function = std::function< void( const unmountScheduler::result& ) > ;
+
+	unmountScheduler( std::vector< unmountScheduler::volume >,int concurrency ) ;
+
+	/*
+	 * Returns after every volume is either unmounted or given up on,events are
+	 * processed in the meantime."function" is called on the calling thread with the
+	 * result of each volume as it comes in.
+	 *
+	 * Returns the number of volumes that were not unmounted.
+	 */
+	int run( unmountScheduler::function ) ;
+private:
+	struct node{
+
+		node( unmountScheduler::volume&& e ) : volume( std::move( e ) )
+		{
+		}
+		unmountScheduler::volume volume ;
+		engines::engine::cmdStatus status ;
+		std::vector< size_t > dependents ;
+		int blockers = 0 ;
+		bool done = false ;
+	} ;
+
+	std::vector< size_t > nextJob() ;
+	void start() ;
+	void finished( const std::vector< size_t >&,const std::vector< engines::engine::cmdStatus >& ) ;
+
+	std::vector< unmountScheduler::node > m_nodes ;
+	std::vector< size_t > m_ready ;
+	unmountScheduler::function m_function ;
+	QEventLoop m_loop ;
+	int m_concurrency ;
+	int m_running = 0 ;
+	int m_failed = 0 ;
+	/*
+	 * How long to wait for an unmounted volume to leave the mount table,it keeps
+	 * nested volumes in order and so it has a lower bound and can not be turned off.
+	 */
+	int m_timeOut ;
+} ;
+
+#endif
@@ -29,6 +29,12 @@
 #include <cstdio>
 #include <memory>
 #include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <set>
+#include <map>
 
 #include <QObject>
 #include <QDir>
@@ -47,7 +53,6 @@
 #include <QMessageBox>
 #include <QTableWidgetItem>
 #include <QProcessEnvironment>
-#include <QtNetwork/QLocalSocket>
 #include <unistd.h>
 #include <QTimer>
 #include <QEventLoop>
@@ -73,10 +78,14 @@
 #include "settings.h"
 #include "version.h"
 #include "runinthread.h"
+#include "processlauncher.h"
+#include "siripolkit/siripolkitprotocol.h"
 
 #ifdef Q_OS_LINUX
 
 #include <sys/vfs.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 bool utility::platformIsLinux()
 {
@@ -148,6 +157,384 @@ static debugWindow * _debugWindow ;
 
 static bool _use_polkit = false ;
 
+#ifdef Q_OS_LINUX
+
+/*
+ * Our side of the connection to siripolkit.
+ *
+ * The connection is made on first use and it is kept open,every request gets an ID and
+ * the thread that sent it sleeps until a response with the same ID is read by the thread
+ * that reads all responses.A lost connection fails all pending requests and the next
+ * request makes a new connection.
+ */
+class siriPolkitClient
+{
+public:
+	static siriPolkitClient& instance()
+	{
+		static auto m = new siriPolkitClient() ;
+
+		return *m ;
+	}
+	::Task::process::result run( const QString& exe,const QStringList& args,const QByteArray& password )
+	{
+		const char * error = nullptr ;
+
+		auto e = this->exchange( error,[ & ]( SirikaliJson& json ){
+
+			json[ "password" ] = password ;
+			json[ "command" ]  = exe ;
+			json[ "args" ]     = args ;
+		} ) ;
+
+		if( e.isEmpty() ){
+
+			return this->error( error ) ;
+		}
+
+		try{
+			SirikaliJson json( e,SirikaliJson::type::CONTENTS,_log ) ;
+
+			return { json.getByteArray( "stdOut" ),
+				 json.getByteArray( "stdError" ),
+				 json.getInterger( "exitCode" ),
+				 json.getInterger( "exitStatus" ),
+				 json.getBool( "finished" ) } ;
+		}catch( ... ){
+
+			return this->error( "SiriKali: Invalid Response From Polkit Backend" ) ;
+		}
+	}
+	std::vector< ::Task::process::result > run( const QString& su,
+						    const QStringList& commands,
+						    const QStringList& passwords )
+	{
+		const char * error = nullptr ;
+
+		auto e = this->exchange( error,[ & ]( SirikaliJson& json ){
+
+			json[ "command" ]   = "batch" ;
+			json[ "exe" ]       = su ;
+			json[ "args" ]      = commands ;
+			json[ "passwords" ] = passwords ;
+		} ) ;
+
+		auto size = static_cast< size_t >( commands.size() ) ;
+
+		if( e.isEmpty() ){
+
+			return std::vector< ::Task::process::result >( size,this->error( error ) ) ;
+		}
+
+		try{
+			SirikaliJson json( e,SirikaliJson::type::CONTENTS,_log ) ;
+
+			auto stdOut       = json.getStringList( "stdOut" ) ;
+			auto stdError     = json.getStringList( "stdError" ) ;
+			auto exitCodes    = json.get< std::vector< int > >( "exitCodes" ) ;
+			auto exitStatuses = json.get< std::vector< int > >( "exitStatuses" ) ;
+			auto finished     = json.get< std::vector< bool > >( "finished" ) ;
+
+			if( stdOut.size() != commands.size() || stdError.size() != commands.size() ||
+			    exitCodes.size() != size || exitStatuses.size() != size || finished.size() != size ){
+
+				auto m = "SiriKali: Invalid Response From Polkit Backend" ;
+
+				return std::vector< ::Task::process::result >( size,this->error( m ) ) ;
+			}
+
+			std::vector< ::Task::process::result > r ;
+
+			for( int i = 0 ; i < commands.size() ; i++ ){
+
+				auto s = static_cast< size_t >( i ) ;
+
+				r.emplace_back( stdOut.at( i ).toUtf8(),
+						stdError.at( i ).toUtf8(),
+						exitCodes[ s ],
+						exitStatuses[ s ],
+						finished[ s ] ) ;
+			}
+
+			return r ;
+
+		}catch( ... ){
+
+			auto m = "SiriKali: Invalid Response From Polkit Backend" ;
+
+			return std::vector< ::Task::process::result >( size,this->error( m ) ) ;
+		}
+	}
+	void quit()
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		this->send( this->request( ++m_nextId,[]( SirikaliJson& json ){
+
+			json[ "command" ] = "exit" ;
+		} ) ) ;
+	}
+private:
+	static void _log( const QString& e )
+	{
+		utility::debug() << e ;
+	}
+	::Task::process::result error( const char * e )
+	{
+		return { QByteArray(),e,-1,-1,true } ;
+	}
+	QByteArray request( qint64 id,std::function< void( SirikaliJson& ) > function )
+	{
+		SirikaliJson json( _log ) ;
+
+		json[ "id" ]     = id ;
+		json[ "cookie" ] = _cookie ;
+
+		function( json ) ;
+
+		return siriPolkitProtocol::message( json.structure() ) ;
+	}
+	/*
+	 * Send a request and wait for its response,an empty response means the request
+	 * failed and "error" says why.
+	 */
+	QByteArray exchange( const char *& error,std::function< void( SirikaliJson& ) > function )
+	{
+		std::unique_lock< std::mutex > lock( m_mutex ) ;
+
+		auto id = ++m_nextId ;
+
+		if( !this->send( this->request( id,std::move( function ) ) ) ){
+
+			utility::debug() << "ERROR: Failed To Start Helper Application" ;
+
+			error = "SiriKali: Failed To Connect To Polkit Backend" ;
+
+			return QByteArray() ;
+		}
+
+		m_pending.insert( id ) ;
+
+		m_cv.wait( lock,[ & ](){ return m_pending.find( id ) == m_pending.end() ; } ) ;
+
+		auto it = m_responses.find( id ) ;
+
+		auto r = std::move( it->second ) ;
+
+		m_responses.erase( it ) ;
+
+		if( r.isEmpty() ){
+
+			error = "SiriKali: Lost Connection To Polkit Backend" ;
+		}
+
+		return r ;
+	}
+	bool connectToHelper()
+	{
+		auto path = utility::helperSocketPath().toUtf8() ;
+
+		struct sockaddr_un addr ;
+
+		if( static_cast< size_t >( path.size() ) >= sizeof( addr.sun_path ) ){
+
+			return false ;
+		}
+
+		memset( &addr,0,sizeof( addr ) ) ;
+
+		addr.sun_family = AF_UNIX ;
+
+		memcpy( addr.sun_path,path.constData(),static_cast< size_t >( path.size() ) ) ;
+
+		auto m = reinterpret_cast< struct sockaddr * >( &addr ) ;
+
+		for( int i = 0 ; i < 20 ; i++ ){
+
+			auto fd = socket( AF_UNIX,SOCK_STREAM | SOCK_CLOEXEC,0 ) ;
+
+			if( fd == -1 ){
+
+				return false ;
+			}
+
+			if( ::connect( fd,m,sizeof( addr ) ) == 0 ){
+
+				m_fd = fd ;
+
+				std::thread( [ this,fd ](){ this->readResponses( fd ) ; } ).detach() ;
+
+				return true ;
+			}
+
+			utility::debug() << QString( "Failed to connect to siripolkit: %1" ).arg( strerror( errno ) ) ;
+
+			close( fd ) ;
+
+			/*
+			 * The helper may still be starting up.
+			 */
+			std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) ) ;
+		}
+
+		return false ;
+	}
+	bool send( const QByteArray& e )
+	{
+		if( m_fd == -1 && !this->connectToHelper() ){
+
+			return false ;
+		}
+
+		int offset = 0 ;
+
+		while( offset < e.size() ){
+
+			auto s = ::send( m_fd,e.constData() + offset,static_cast< size_t >( e.size() - offset ),MSG_NOSIGNAL ) ;
+
+			if( s > 0 ){
+
+				offset += static_cast< int >( s ) ;
+
+			}else if( s == -1 && errno == EINTR ){
+
+				continue ;
+			}else{
+				shutdown( m_fd,SHUT_RDWR ) ;
+
+				return false ;
+			}
+		}
+
+		return true ;
+	}
+	void readResponses( int fd )
+	{
+		QByteArray buffer ;
+		QByteArray message ;
+
+		char data[ 4096 ] ;
+
+		while( true ){
+
+			auto s = read( fd,data,sizeof( data ) ) ;
+
+			if( s == -1 && errno == EINTR ){
+
+				continue ;
+
+			}else if( s <= 0 ){
+
+				break ;
+			}
+
+			buffer.append( data,static_cast< int >( s ) ) ;
+
+			while( true ){
+
+				auto m = siriPolkitProtocol::nextMessage( buffer,message ) ;
+
+				if( m == siriPolkitProtocol::status::complete ){
+
+					this->response( message ) ;
+
+				}else if( m == siriPolkitProtocol::status::incomplete ){
+
+					break ;
+				}else{
+					return this->disconnected( fd ) ;
+				}
+			}
+		}
+
+		this->disconnected( fd ) ;
+	}
+	void response( const QByteArray& e )
+	{
+		qint64 id = -1 ;
+
+		try{
+			id = SirikaliJson( e,SirikaliJson::type::CONTENTS,_log ).get< qint64 >( "id",-1 ) ;
+
+		}catch( ... ){
+
+			utility::debug() << "ERROR: Invalid Response From siripolkit" ;
+		}
+
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		if( m_pending.erase( id ) ){
+
+			m_responses[ id ] = e ;
+
+			m_cv.notify_all() ;
+		}
+	}
+	void disconnected( int fd )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex ) ;
+
+		close( fd ) ;
+
+		if( m_fd == fd ){
+
+			m_fd = -1 ;
+		}
+
+		for( const auto& it : m_pending ){
+
+			m_responses[ it ] = QByteArray() ;
+		}
+
+		m_pending.clear() ;
+
+		m_cv.notify_all() ;
+	}
+	std::mutex m_mutex ;
+	std::condition_variable m_cv ;
+	int m_fd = -1 ;
+	qint64 m_nextId = 0 ;
+	std::set< qint64 > m_pending ;
+	std::map< qint64,QByteArray > m_responses ;
+} ;
+
+#else
+
+class siriPolkitClient
+{
+public:
+	static siriPolkitClient& instance()
+	{
+		static siriPolkitClient m ;
+
+		return m ;
+	}
+	::Task::process::result run( const QString& exe,const QStringList& args,const QByteArray& password )
+	{
+		Q_UNUSED( exe )
+		Q_UNUSED( args )
+		Q_UNUSED( password )
+
+		return { QByteArray(),"SiriKali: Polkit Is Not Supported",-1,-1,true } ;
+	}
+	std::vector< ::Task::process::result > run( const QString& su,
+						    const QStringList& commands,
+						    const QStringList& passwords )
+	{
+		Q_UNUSED( su )
+		Q_UNUSED( passwords )
+
+		auto size = static_cast< size_t >( commands.size() ) ;
+
+		return std::vector< ::Task::process::result >( size,this->run( su,commands,QByteArray() ) ) ;
+	}
+	void quit()
+	{
+	}
+} ;
+
+#endif
+
 static std::function< void() > _failed_to_connect_to_zulupolkit ;
 
 static bool _enable_debug = false ;
@@ -229,11 +616,11 @@ void utility::polkitFailedWarning( std::function< void() > e )
 						     const QStringList& list,
 						     int s,bool e )
 {
-	return ::Task::run( [ = ](){
+	return ::Task::run_io( [ = ](){
 
 		const auto& env = utility::systemEnvironment() ;
 
-		return utility::Task( exe,list,s,env,QByteArray(),[](){},e ) ;
+		return utility::Task( exe,list,s,env,QByteArray(),nullptr,e ) ;
 	} ) ;
 }
 
@@ -248,71 +635,38 @@ void utility::Task::execute( const QString& exe,
 {
 	if( polkit && utility::useSiriPolkit() ){
 
-		auto _report_error = [ this ]( const char * msg ){
-
-			m_finished   = true ;
-			m_exitCode   = -1 ;
-			m_exitStatus = -1 ;
-			m_stdError   =  msg ;
-			//m_stdOut     =  "" ;
-		} ;
-
-		QLocalSocket s ;
-
-		s.connectToServer( utility::helperSocketPath() ) ;
-
-		for( int i = 0 ; ; i++ ){
-
-			if( s.waitForConnected() ){
-
-				break ;
-
-			}else if( i == 3 ){
-
-				_report_error( "SiriKali: Failed To Connect To Polkit Backend" ) ;
-
-				utility::debug() << "ERROR: Failed To Start Helper Application" ;
-				return ;
-			}else{
-				utility::debug() << s.errorString() ;
-
-				utility::waitForOneSecond() ;
-			}
-		}
-
-		s.write( [ & ]()->QByteArray{
-
-			SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+		auto s = siriPolkitClient::instance().run( exe,list,password ) ;
 
-			json[ "cookie" ]   = _cookie ;
-			json[ "password" ] = password ;
-			json[ "command" ]  = exe ;
-			json[ "args" ]     = list ;
+		m_finished   = s.finished() ;
+		m_exitCode   = s.exit_code() ;
+		m_exitStatus = s.exit_status() ;
+		m_stdError   = s.std_error() ;
+		m_stdOut     = s.std_out() ;
 
-			return json.structure() ;
-		}() ) ;
-
-		s.waitForBytesWritten() ;
+		utility::logCommandOutPut( s,exe,list ) ;
+	}else{
+		if( runs_in_background ){
 
-		s.waitForReadyRead() ;
+			auto s = [ & ](){
 
-		SirikaliJson json( s.readAll(),
-				   SirikaliJson::type::CONTENTS,
-				   []( const QString& e ){ utility::debug() << e ; } ) ;
+				if( function ){
 
-		m_finished   = json.getBool( "finished" ) ;
-		m_exitCode   = json.getInterger( "exitCode" ) ;
-		m_exitStatus = json.getInterger( "exitStatus" ) ;
-		m_stdError   = json.getByteArray( "stdError" ) ;
-		m_stdOut     = json.getByteArray( "stdOut" ) ;
+					auto& m = ::Task::process::run( exe,list,waitTime,password,env,std::move( function ) ) ;
 
-		utility::logCommandOutPut( { m_stdOut,m_stdError,m_exitCode,m_exitStatus,m_finished },exe,list ) ;
-	}else{
-		if( runs_in_background ){
+					return utility::unwrap( m ) ;
+				}else{
+					/*
+					 * QProcess is only needed when something has to run in the
+					 * child before exec.
+					 */
+					auto& m = ::Task::run_io( [ & ](){
 
-			auto& ss = ::Task::process::run( exe,list,waitTime,password,env,std::move( function ) ) ;
+						return processLauncher::run( exe,list,waitTime,password,env ) ;
+					} ) ;
 
-			auto s = utility::unwrap( ss ) ;
+					return utility::unwrap( m ) ;
+				}
+			}() ;
 
 			m_finished   = s.finished() ;
 			m_exitCode   = s.exit_code() ;
@@ -485,14 +839,14 @@ static ::Task::future< utility::Task >& _start_siripolkit( const engines::engine
 {
 	_cookie = crypto::getRandomData( 16 ).toHex() ;
 
-	return ::Task::run( [ = ]{
+	return ::Task::run_io( [ = ]{
 
 		return utility::Task( e.exe,
 				      e.args,
 				      -1,
 				      utility::systemEnvironment(),
 				      _cookie,
-				      [](){},
+				      nullptr,
 				      false ) ;
 	} ) ;
 }
@@ -562,34 +916,31 @@ bool utility::useSiriPolkit()
 	return _use_polkit ;
 }
 
-void utility::quitHelper()
+std::vector< ::Task::process::result > utility::polkitBatch( const QString& su,
+							    const QStringList& commands,
+							    const QStringList& passwords )
 {
-	#ifdef Q_OS_LINUX
+	auto m = siriPolkitClient::instance().run( su,commands,passwords ) ;
 
-		auto e = utility::helperSocketPath() ;
+	for( size_t i = 0 ; i < m.size() ; i++ ){
 
-		if( utility::pathExists( e ) ){
-
-			QLocalSocket s ;
+		QStringList args{ "-","-c",commands.at( static_cast< int >( i ) ) } ;
 
-			s.connectToServer( e ) ;
-
-			if( s.waitForConnected() ){
+		utility::logCommandOutPut( m[ i ],su,args ) ;
+	}
 
-				s.write( [ & ]()->QByteArray{
+	return m ;
+}
 
-					SirikaliJson json( []( const QString& e ){ utility::debug() << e ; } ) ;
+void utility::quitHelper()
+{
+	#ifdef Q_OS_LINUX
 
-					json[ "cookie" ]   = _cookie ;
-					json[ "password" ] = "" ;
-					json[ "command" ]  = "exit" ;
-					json[ "args" ]     = QStringList() ;
+		auto e = utility::helperSocketPath() ;
 
-					return json.structure() ;
-				}() ) ;
+		if( utility::pathExists( e ) ){
 
-				s.waitForBytesWritten() ;
-			}
+			siriPolkitClient::instance().quit() ;
 		}
 
 		auto a = "/tmp/SiriKali-" + QString::number( getuid() ) ;
@@ -602,7 +953,7 @@ void utility::quitHelper()
 
 ::Task::future<bool>& utility::openPath( const QString& path,const QString& opener )
 {
-	return ::Task::run( [ = ](){
+	return ::Task::run_io( [ = ](){
 
 		return utility::Task::run( opener,{ path } ).get().failed() ;
 	} ) ;
@@ -303,6 +303,14 @@ namespace utility
 	void setDebugWindow( debugWindow * ) ;
 	void polkitFailedWarning( std::function< void() > ) ;
 	bool useSiriPolkit( void ) ;
+
+	/*
+	 * Run "su - -c" commands through siripolkit with a single request,they run in
+	 * parallel and their results come back in the order of "commands".
+	 */
+	std::vector< ::Task::process::result > polkitBatch( const QString& su,
+							    const QStringList& commands,
+							    const QStringList& passwords = QStringList() ) ;
 	void quitHelper() ;
 	void initGlobals() ;
 	QString helperSocketPath() ;
@@ -440,7 +448,7 @@ namespace utility
 							     const QStringList& list,
 							     const QByteArray& password = QByteArray() )
 		{
-			return ::Task::run( [ = ](){
+			return ::Task::run_io( [ = ](){
 
 				return utility::Task( exe,list,-1,utility::systemEnvironment(),password ) ;
 			} ) ;
@@ -449,9 +457,9 @@ namespace utility
 		static void exec( const QString& exe,
 				  const QStringList& list,
 				  const QProcessEnvironment& env = utility::systemEnvironment(),
-				  std::function< void() > f = [](){} )
+				  std::function< void() > f = nullptr )
 		{
-			::Task::exec( [ = ](){ utility::Task( exe,list,env,f ) ; } ) ;
+			::Task::run_io( [ = ](){ utility::Task( exe,list,env,f ) ; } ).start() ;
 		}
 		static void wait( int s )
 		{
@@ -497,7 +505,7 @@ namespace utility
 		      int waitTime = -1,
 		      const QProcessEnvironment& env = utility::systemEnvironment(),
 		      const QByteArray& password = QByteArray(),
-		      std::function< void() > f = [](){},
+		      std::function< void() > f = nullptr,
 		      bool use_polkit = false,
 		      bool runs_in_background = true )
 		{
@@ -0,0 +1,283 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "volumeregistry.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+
+static bool _same_row( const volumeRegistry::entry& a,const volumeRegistry::entry& b )
+{
+	return a.volumePath == b.volumePath &&
+	       a.mountPoint == b.mountPoint &&
+	       a.fileSystem == b.fileSystem &&
+	       a.mode == b.mode ;
+}
+
+void volumeRegistry::update( const std::vector< volumeInfo >& e )
+{
+	/*
+	 * A later entry with the same mount point replaces the earlier one and takes
+	 * its position.
+	 */
+	std::vector< volumeRegistry::entry > volumes ;
+	QHash< QString,int > mountPoints ;
+
+	volumes.reserve( e.size() ) ;
+	mountPoints.reserve( static_cast< int >( e.size() ) ) ;
+
+	for( const auto& it : e ){
+
+		if( it.isNotValid() ){
+
+			continue ;
+		}
+
+		const auto& m = it.mountInfo() ;
+
+		auto s = mountPoints.find( m.mountPoint ) ;
+
+		if( s == mountPoints.end() ){
+
+			mountPoints.insert( m.mountPoint,static_cast< int >( volumes.size() ) ) ;
+			volumes.emplace_back( m ) ;
+		}else{
+			volumes[ static_cast< size_t >( s.value() ) ] = m ;
+		}
+	}
+
+	/*
+	 * Remove rows that are gone,adjacent rows are removed together.Going from the
+	 * bottom up keeps the positions of rows we have not looked at yet valid.
+	 */
+	bool removed = false ;
+
+	for( int row = this->size() - 1 ; row >= 0 ; row-- ){
+
+		if( mountPoints.contains( this->at( row ).mountPoint ) ){
+
+			continue ;
+		}
+
+		int last = row ;
+
+		while( row > 0 && !mountPoints.contains( this->at( row - 1 ).mountPoint ) ){
+
+			row-- ;
+		}
+
+		this->beginRemoveRows( QModelIndex(),row,last ) ;
+
+		m_entries.erase( m_entries.begin() + row,m_entries.begin() + last + 1 ) ;
+
+		this->endRemoveRows() ;
+
+		removed = true ;
+	}
+
+	if( removed ){
+
+		this->reindex() ;
+	}
+
+	std::vector< const volumeRegistry::entry * > added ;
+
+	bool cipherPathChanged = false ;
+
+	for( const auto& it : volumes ){
+
+		auto row = this->row( it.mountPoint ) ;
+
+		if( row == -1 ){
+
+			added.emplace_back( &it ) ;
+			continue ;
+		}
+
+		auto& m = m_entries[ static_cast< size_t >( row ) ] ;
+
+		if( _same_row( m,it ) ){
+
+			m = it ;
+		}else{
+			if( m.volumePath != it.volumePath ){
+
+				cipherPathChanged = true ;
+			}
+
+			m = it ;
+
+			emit this->dataChanged( this->index( row,0 ),this->index( row,this->columnCount() - 1 ) ) ;
+		}
+	}
+
+	if( cipherPathChanged ){
+
+		this->reindex() ;
+	}
+
+	if( !added.empty() ){
+
+		auto first = this->size() ;
+		auto last = first + static_cast< int >( added.size() ) - 1 ;
+
+		this->beginInsertRows( QModelIndex(),first,last ) ;
+
+		for( const auto& it : added ){
+
+			m_entries.emplace_back( *it ) ;
+
+			this->addToIndex( this->size() - 1 ) ;
+		}
+
+		this->endInsertRows() ;
+	}
+}
+
+void volumeRegistry::remove( const QString& mountPoint )
+{
+	auto row = this->row( mountPoint ) ;
+
+	if( row != -1 ){
+
+		this->beginRemoveRows( QModelIndex(),row,row ) ;
+
+		m_entries.erase( m_entries.begin() + row ) ;
+
+		this->endRemoveRows() ;
+
+		this->reindex() ;
+	}
+}
+
+void volumeRegistry::retranslate()
+{
+	emit this->headerDataChanged( Qt::Horizontal,0,this->columnCount() - 1 ) ;
+}
+
+int volumeRegistry::row( const QString& mountPoint ) const
+{
+	return m_mountPoints.value( mountPoint,-1 ) ;
+}
+
+const std::vector< int >& volumeRegistry::rows( const QString& cipherPath ) const
+{
+	static const std::vector< int > empty ;
+
+	auto it = m_cipherPaths.find( cipherPath ) ;
+
+	if( it == m_cipherPaths.end() ){
+
+		return empty ;
+	}else{
+		return it.value() ;
+	}
+}
+
+int volumeRegistry::rowCount( const QModelIndex& parent ) const
+{
+	if( parent.isValid() ){
+
+		return 0 ;
+	}else{
+		return this->size() ;
+	}
+}
+
+int volumeRegistry::columnCount( const QModelIndex& parent ) const
+{
+	if( parent.isValid() ){
+
+		return 0 ;
+	}else{
+		return 4 ;
+	}
+}
+
+QVariant volumeRegistry::data( const QModelIndex& index,int role ) const
+{
+	if( !index.isValid() || index.row() >= this->size() ){
+
+		return QVariant() ;
+	}
+
+	if( role == Qt::TextAlignmentRole ){
+
+		return static_cast< int >( Qt::AlignCenter ) ;
+
+	}else if( role == Qt::DisplayRole ){
+
+		const auto& e = this->at( index.row() ) ;
+
+		switch( index.column() ){
+
+		case 0 : return e.volumePath ;
+		case 1 : return e.mountPoint ;
+		case 2 : return e.fileSystem ;
+		case 3 : return e.mode ;
+		default: return QVariant() ;
+		}
+	}else{
+		return QVariant() ;
+	}
+}
+
+QVariant volumeRegistry::headerData( int section,Qt::Orientation orientation,int role ) const
+{
+	if( orientation == Qt::Horizontal && section >= 0 && section < this->columnCount() ){
+
+		static const char * names[] = { QT_TRANSLATE_NOOP( "sirikali","Volume Path" ),
+						QT_TRANSLATE_NOOP( "sirikali","Mount Point Path" ),
+						QT_TRANSLATE_NOOP( "sirikali","File System" ),
+						QT_TRANSLATE_NOOP( "sirikali","Mode" ) } ;
+
+		if( role == Qt::DisplayRole ){
+
+			return QCoreApplication::translate( "sirikali",names[ section ] ) ;
+
+		}else if( role == Qt::TextAlignmentRole ){
+
+			return static_cast< int >( Qt::AlignCenter ) ;
+		}
+	}
+
+	return QAbstractTableModel::headerData( section,orientation,role ) ;
+}
+
+void volumeRegistry::addToIndex( int row )
+{
+	const auto& e = this->at( row ) ;
+
+	m_mountPoints.insert( e.mountPoint,row ) ;
+	m_cipherPaths[ e.volumePath ].emplace_back( row ) ;
+}
+
+void volumeRegistry::reindex()
+{
+	m_mountPoints.clear() ;
+	m_cipherPaths.clear() ;
+
+	m_mountPoints.reserve( this->size() ) ;
+
+	for( int row = 0 ; row < this->size() ; row++ ){
+
+		this->addToIndex( row ) ;
+	}
+}
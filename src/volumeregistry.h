@@ -0,0 +1,86 @@
+/*
+ *
+ *  Copyright (c) 2020
+ *  name : Francis Banyikwa
+ *  email: mhogomchungu@gmail.com
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef VOLUME_REGISTRY_H
+#define VOLUME_REGISTRY_H
+
+#include <QString>
+#include <QHash>
+#include <QAbstractTableModel>
+
+#include <vector>
+
+#include "volumeinfo.h"
+
+/*
+ * The volumes we currently show as unlocked,in the order they are shown.It is also
+ * the model behind the main window's volume table.
+ *
+ * Volumes are keyed by their mount point since no two volumes can share one,a cipher
+ * folder can be mounted more than once and looking one up gives back every position
+ * it occupies.Both lookups are hash based.
+ *
+ * update() compares the new list with what is already shown and only removes,inserts
+ * or changes the rows that differ,rows that did not change are left alone.
+ */
+class volumeRegistry : public QAbstractTableModel
+{
+public:
+	using entry = volumeInfo::mountinfo ;
+
+	void update( const std::vector< volumeInfo >& ) ;
+	void remove( const QString& mountPoint ) ;
+
+	/*
+	 * Header text is translated when asked for,call this after the language changes.
+	 */
+	void retranslate() ;
+
+	/*
+	 * Returns -1 if nothing is mounted at "mountPoint".
+	 */
+	int row( const QString& mountPoint ) const ;
+	const std::vector< int >& rows( const QString& cipherPath ) const ;
+
+	const volumeRegistry::entry& at( int row ) const
+	{
+		return m_entries[ static_cast< size_t >( row ) ] ;
+	}
+	const std::vector< volumeRegistry::entry >& entries() const
+	{
+		return m_entries ;
+	}
+	int size() const
+	{
+		return static_cast< int >( m_entries.size() ) ;
+	}
+
+	int rowCount( const QModelIndex& parent = QModelIndex() ) const override ;
+	int columnCount( const QModelIndex& parent = QModelIndex() ) const override ;
+	QVariant data( const QModelIndex&,int role = Qt::DisplayRole ) const override ;
+	QVariant headerData( int section,Qt::Orientation,int role = Qt::DisplayRole ) const override ;
+private:
+	void addToIndex( int row ) ;
+	void reindex() ;
+	std::vector< volumeRegistry::entry > m_entries ;
+	QHash< QString,int > m_mountPoints ;
+	QHash< QString,std::vector< int > > m_cipherPaths ;
+} ;
+
+#endif